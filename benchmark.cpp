@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <iomanip>
+#include "benchmark.hpp"
+
+
+void BenchmarkReport::add(const BenchmarkResult& result)
+{
+	_results.push_back(result);
+
+	const LatencySummary& latency = result.latency;
+	std::cout << std::left << std::setw(28) << result.container << std::setw(12) << result.operation
+		<< std::right << "p50 " << std::setw(6) << latency.p50 << "ns, p99 " << std::setw(7) << latency.p99
+		<< "ns, p99.9 " << std::setw(8) << latency.p999 << "ns, max " << std::setw(9) << latency.max
+		<< "ns, " << std::setw(11) << (long long) latency.ops_per_sec << " ops/s";
+	if (result.resizes > 0)
+		std::cout << ", " << result.resizes << " resizes";
+	std::cout << std::endl;
+}
+
+//names like "SmallDeque<int, 16>" carry commas, so text fields are always quoted
+static std::string CsvField(const std::string& text)
+{
+	return "\"" + text + "\"";
+}
+
+void BenchmarkReport::write_csv(std::ostream& out) const
+{
+	out << "suite,container,size,operation,samples,p50_ns,p99_ns,p999_ns,max_ns,ops_per_sec,resizes"
+		<< std::endl;
+	for (const auto& result : _results)
+	{
+		const LatencySummary& latency = result.latency;
+		out << CsvField(result.suite) << "," << CsvField(result.container) << "," << result.size << ","
+			<< CsvField(result.operation) << "," << latency.samples << "," << latency.p50 << ","
+			<< latency.p99 << "," << latency.p999 << "," << latency.max << ","
+			<< (long long) latency.ops_per_sec << "," << result.resizes << std::endl;
+	}
+}
+
+void BenchmarkReport::write_json(std::ostream& out) const
+{
+	out << "[" << std::endl;
+	for (std::size_t i = 0; i < _results.size(); ++i)
+	{
+		const BenchmarkResult& result = _results[i];
+		const LatencySummary& latency = result.latency;
+		out << "\t{\"suite\": \"" << result.suite << "\", \"container\": \"" << result.container
+			<< "\", \"size\": " << result.size << ", \"operation\": \"" << result.operation
+			<< "\", \"samples\": " << latency.samples << ", \"p50_ns\": " << latency.p50
+			<< ", \"p99_ns\": " << latency.p99 << ", \"p999_ns\": " << latency.p999
+			<< ", \"max_ns\": " << latency.max << ", \"ops_per_sec\": " << (long long) latency.ops_per_sec
+			<< ", \"resizes\": " << result.resizes << "}" << (i + 1 < _results.size() ? "," : "")
+			<< std::endl;
+	}
+	out << "]" << std::endl;
+}
+
+long long ClockOverhead()
+{
+	const std::size_t COUNT = 10001;
+	std::vector<long long> samples;
+	samples.reserve(COUNT);
+	for (std::size_t i = 0; i < COUNT; ++i)
+	{
+		bench_clock_t::time_point before(bench_clock_t::now());
+		samples.push_back(ElapsedNs(before, bench_clock_t::now()));
+	}
+	std::nth_element(samples.begin(), samples.begin() + COUNT/2, samples.end());
+	return samples[COUNT/2];
+}
+
+LatencySummary Summarize(std::vector<long long>& samples, long long total_ns)
+{
+	LatencySummary result {samples.size(), 0, 0, 0, 0, 0.0};
+	if (samples.empty())
+		return result;
+
+	std::sort(samples.begin(), samples.end());
+	std::size_t count = samples.size();
+	result.p50 = samples[count/2];
+	result.p99 = samples[count*99/100];
+	result.p999 = samples[count*999/1000];
+	result.max = samples.back();
+
+	if (total_ns == 0)
+	{
+		for (auto sample : samples)
+			total_ns += sample;
+	}
+	result.ops_per_sec = total_ns > 0 ? count*1e9/total_ns : 0.0;
+	return result;
+}
+
+LatencyHistogram::LatencyHistogram()
+	: _counts(BUCKET_COUNT), _samples(0), _sum(0), _max(0)
+{
+
+}
+
+void LatencyHistogram::add(long long sample)
+{
+	if (sample < 0)
+		sample = 0;
+	++_counts[_bucket(sample)];
+	++_samples;
+	_sum += sample;
+	_max = std::max(_max, sample);
+}
+
+LatencySummary LatencyHistogram::summarize(long long total_ns) const
+{
+	LatencySummary result {_samples, 0, 0, 0, _max, 0.0};
+	if (_samples == 0)
+		return result;
+
+	result.p50 = _percentile(_samples/2);
+	result.p99 = _percentile(_samples*99/100);
+	result.p999 = _percentile(_samples*999/1000);
+
+	if (total_ns == 0)
+		total_ns = _sum;
+	result.ops_per_sec = total_ns > 0 ? _samples*1e9/total_ns : 0.0;
+	return result;
+}
+
+std::size_t LatencyHistogram::_bucket(long long sample)
+{
+	unsigned long long value = sample;
+	if (value < LINEAR)
+		return value;
+
+	//the top bit picks the power of two, the next five bits the sub-bucket
+	std::size_t exponent = 63 - __builtin_clzll(value);
+	std::size_t sub = (value >> (exponent - 5)) & (SUB_BUCKETS - 1);
+	return LINEAR + (exponent - 6)*SUB_BUCKETS + sub;
+}
+
+long long LatencyHistogram::_lower_bound(std::size_t bucket)
+{
+	if (bucket < LINEAR)
+		return bucket;
+
+	std::size_t exponent = (bucket - LINEAR)/SUB_BUCKETS + 6;
+	std::size_t sub = (bucket - LINEAR) % SUB_BUCKETS;
+	return (1ll << exponent) | ((long long) sub << (exponent - 5));
+}
+
+long long LatencyHistogram::_percentile(std::size_t rank) const
+{
+	std::size_t seen = 0;
+	for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		seen += _counts[i];
+		if (seen > rank)
+			return std::min(_lower_bound(i), _max);
+	}
+	return _max;
+}
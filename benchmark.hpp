@@ -0,0 +1,85 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+
+using bench_clock_t = std::chrono::steady_clock;
+
+//distribution of a batch of latency samples, in nanoseconds
+struct LatencySummary
+{
+	std::size_t samples;
+	long long p50;
+	long long p99;
+	long long p999;
+	long long max;
+	double ops_per_sec;
+};
+
+//one line of the results: how one container did on one operation of one workload
+struct BenchmarkResult
+{
+	std::string suite;
+	std::string container;
+	std::size_t size;
+	std::string operation;
+	LatencySummary latency;
+	std::size_t resizes;
+};
+
+//collects results, echoes them to the console and writes them out
+//as CSV or JSON, so that runs from different commits can be diffed
+class BenchmarkReport
+{
+public:
+	void add(const BenchmarkResult&);
+
+	void write_csv(std::ostream&) const;
+	void write_json(std::ostream&) const;
+
+private:
+	std::vector<BenchmarkResult> _results;
+};
+
+//fixed-size log-linear histogram for runs too long to keep every sample,
+//values are exact below 64ns and within about 3% above
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+
+	void add(long long);
+	LatencySummary summarize(long long total_ns) const;
+
+private:
+	static std::size_t _bucket(long long);
+	static long long _lower_bound(std::size_t);
+	long long _percentile(std::size_t rank) const;
+
+	static const std::size_t LINEAR = 64;
+	static const std::size_t SUB_BUCKETS = 32;
+	static const std::size_t BUCKET_COUNT = LINEAR + 58*SUB_BUCKETS;
+
+	std::vector<std::size_t> _counts;
+	std::size_t _samples;
+	long long _sum;
+	long long _max;
+};
+
+//the cost of reading the clock, subtracted from every sample
+long long ClockOverhead();
+
+//sorts the samples; total_ns is the untimed duration of the whole batch,
+//or 0 to derive the throughput from the samples themselves
+LatencySummary Summarize(std::vector<long long>& samples, long long total_ns);
+
+inline long long ElapsedNs(bench_clock_t::time_point start, bench_clock_t::time_point end)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef BLOCK_DEQUE_HPP
+#define BLOCK_DEQUE_HPP
+
+#include <memory>
+#include <utility>
+#include <cstring>
+#include <cstddef>
+#include "deque.hpp"
+
+
+//elements per block: the largest power of two that fits in 4 KiB, but at least 16
+template<typename T>
+constexpr std::size_t _default_block_size()
+{
+	std::size_t result = 16;
+	while (2*result*sizeof(T) <= 4096) 
+		result *= 2;
+	return result;
+}
+
+//segmented deque: elements live in fixed-size blocks that are never moved,
+//so pushes and pops at the ends keep references to other elements valid and
+//cost at most one block allocation instead of a copy of the whole container.
+//only the small map of block pointers is ever reallocated.
+template<typename T, std::size_t BlockSize = _default_block_size<T>()>
+class BlockDeque
+{
+public:
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+
+	using value_type = T;
+	using reference = value_type&;
+	using pointer = value_type*;
+
+	using const_value_type = const T;
+	using const_reference = const value_type&;
+	using const_pointer = const value_type*;
+
+	using iterator = _iterator_base<BlockDeque<T, BlockSize>*>;
+	using const_iterator = _iterator_base<const BlockDeque<T, BlockSize>*>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	BlockDeque();
+	BlockDeque(const BlockDeque<T, BlockSize>&);
+	BlockDeque(BlockDeque<T, BlockSize>&&) noexcept;
+
+	bool empty() const;
+	size_type size() const;
+	size_type capacity() const;
+
+	void clear();
+	void reserve(size_type);
+	void shrink_to_fit();
+
+	reference operator[](difference_type);
+	const_reference operator[](difference_type) const;
+
+	BlockDeque<T, BlockSize>& operator=(const BlockDeque<T, BlockSize>&);
+	BlockDeque<T, BlockSize>& operator=(BlockDeque<T, BlockSize>&&) noexcept;
+
+	void swap(BlockDeque<T, BlockSize>&) noexcept;
+
+	void push_back(const_reference);
+	void push_back(value_type&&);
+	template<typename... TArgs>
+	reference emplace_back(TArgs&&...);
+	void pop_back();
+
+	void push_front(const_reference);
+	void push_front(value_type&&);
+	template<typename... TArgs>
+	reference emplace_front(TArgs&&...);
+	void pop_front();
+
+	reference back();
+	const_reference back() const;
+
+	reference front();
+	const_reference front() const;
+
+	iterator begin();
+	const_iterator begin() const;
+	const_iterator cbegin() const;
+
+	iterator end();
+	const_iterator end() const;
+	const_iterator cend() const;
+
+	reverse_iterator rbegin();
+	const_reverse_iterator rbegin() const;
+	const_reverse_iterator crbegin() const;
+
+	reverse_iterator rend();
+	const_reverse_iterator rend() const;
+	const_reverse_iterator crend() const;
+
+	~BlockDeque();
+
+private:
+	using _allocator_type = std::allocator<T>;
+	using _allocator_traits = std::allocator_traits<_allocator_type>;
+	using _map_allocator_type = std::allocator<T*>;
+	using _map_allocator_traits = std::allocator_traits<_map_allocator_type>;
+
+	reference _get(difference_type) const;
+
+	T* _acquire_block();
+	void _release_block(T*);
+	void _push_block_back();
+	void _push_block_front();
+	void _make_map_room();
+	void _remap(size_type);
+
+	//_map[_map_begin, _map_end) are the allocated blocks, elements occupy
+	//positions [_start, _start + _size) counted from the first slot of _map[_map_begin]
+	T** _map;
+	size_type _map_size;
+	size_type _map_begin;
+	size_type _map_end;
+	size_type _size;
+	size_type _start;
+
+	//one freed block is kept around, so that a deque hovering
+	//around a block boundary does not hit the allocator on every operation
+	T* _spare;
+
+	_allocator_type _alloc;
+	_map_allocator_type _map_alloc;
+
+	static const size_type MIN_MAP_SIZE = 8;
+
+	static_assert(BlockSize > 0 && (BlockSize & (BlockSize - 1)) == 0,
+		"Block size must be a power of two");
+};
+
+template<typename T, std::size_t BlockSize>
+void swap(BlockDeque<T, BlockSize>&, BlockDeque<T, BlockSize>&) noexcept;
+
+#include "block_deque.tpp"
+
+#endif //BLOCK_DEQUE_HPP
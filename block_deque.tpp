@@ -0,0 +1,397 @@
+#include "block_deque.hpp"
+
+template<typename T, std::size_t BlockSize>
+BlockDeque<T, BlockSize>::BlockDeque()
+	: _map(nullptr), _map_size(0), _map_begin(0), _map_end(0), _size(0), _start(0), 
+	_spare(nullptr)
+{
+
+}
+
+template<typename T, std::size_t BlockSize>
+BlockDeque<T, BlockSize>::BlockDeque(const BlockDeque<T, BlockSize>& other)
+	: BlockDeque()
+{
+	//the delegated constructor has finished, so a throwing push runs the destructor
+	for (size_type i = 0; i < other._size; ++i)
+		push_back(other[i]);
+}
+
+template<typename T, std::size_t BlockSize>
+BlockDeque<T, BlockSize>::BlockDeque(BlockDeque<T, BlockSize>&& other) noexcept
+	: BlockDeque()
+{
+	swap(other);
+}
+
+template<typename T, std::size_t BlockSize>
+bool BlockDeque<T, BlockSize>::empty() const
+{
+	return _size == 0;
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::size_type BlockDeque<T, BlockSize>::size() const
+{
+	return _size;
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::size_type BlockDeque<T, BlockSize>::capacity() const
+{
+	return (_map_end - _map_begin)*BlockSize;
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::clear()
+{
+	for (size_type i = 0; i < _size; ++i)
+		_allocator_traits::destroy(_alloc, &_get(i));
+
+	for (size_type i = _map_begin; i < _map_end; ++i)
+		_release_block(_map[i]);
+
+	_map_begin = _map_end = _map_size/2;
+	_size = 0;
+	_start = 0;
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::reserve(typename BlockDeque<T, BlockSize>::size_type amount)
+{
+	//extra blocks go to the back, the front still allocates on demand
+	while (_start + amount > capacity())
+		_push_block_back();
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::shrink_to_fit()
+{
+	while (_map_end > _map_begin && _start + _size <= (_map_end - _map_begin - 1)*BlockSize)
+		_release_block(_map[--_map_end]);
+
+	if (_spare != nullptr)
+	{
+		_allocator_traits::deallocate(_alloc, _spare, BlockSize);
+		_spare = nullptr;
+	}
+
+	size_type used = _map_end - _map_begin;
+	if (_map_size > MIN_MAP_SIZE && 4*used <= _map_size)
+		_remap(2*used < MIN_MAP_SIZE ? MIN_MAP_SIZE : 2*used);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::reference 
+	BlockDeque<T, BlockSize>::operator[](BlockDeque<T, BlockSize>::difference_type index)
+{
+	return _get(index);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_reference 
+	BlockDeque<T, BlockSize>::operator[](BlockDeque<T, BlockSize>::difference_type index) const
+{
+	return _get(index);
+}
+
+template<typename T, std::size_t BlockSize>
+BlockDeque<T, BlockSize>& BlockDeque<T, BlockSize>::operator=(
+	const BlockDeque<T, BlockSize>& other)
+{
+	if (this == &other) 
+		return *this;
+	BlockDeque<T, BlockSize> copy(other);
+	swap(copy);
+	return *this;
+}
+
+template<typename T, std::size_t BlockSize>
+BlockDeque<T, BlockSize>& BlockDeque<T, BlockSize>::operator=(
+	BlockDeque<T, BlockSize>&& other) noexcept
+{
+	if (this == &other) 
+		return *this;
+	BlockDeque<T, BlockSize> tmp(std::move(other));
+	swap(tmp);
+	return *this;
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::swap(BlockDeque<T, BlockSize>& other) noexcept
+{
+	std::swap(_map, other._map);
+	std::swap(_map_size, other._map_size);
+	std::swap(_map_begin, other._map_begin);
+	std::swap(_map_end, other._map_end);
+	std::swap(_size, other._size);
+	std::swap(_start, other._start);
+	std::swap(_spare, other._spare);
+}
+
+template<typename T, std::size_t BlockSize>
+void swap(BlockDeque<T, BlockSize>& first, BlockDeque<T, BlockSize>& second) noexcept
+{
+	first.swap(second);
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::push_back(BlockDeque<T, BlockSize>::const_reference value)
+{
+	emplace_back(value);
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::push_back(BlockDeque<T, BlockSize>::value_type&& value)
+{
+	emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t BlockSize>
+template<typename... TArgs>
+typename BlockDeque<T, BlockSize>::reference BlockDeque<T, BlockSize>::emplace_back(
+	TArgs&&... args)
+{
+	//elements never move, so args referring to our own elements stay valid
+	if (_start + _size == capacity()) 
+		_push_block_back();
+	_allocator_traits::construct(_alloc, &_get(_size), std::forward<TArgs>(args)...);
+	++_size;
+	return back();
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::pop_back()
+{
+	//behaviour on empty containers is undefined, just as it is in STL
+	_allocator_traits::destroy(_alloc, &back());
+	--_size;
+	if (_start + _size <= (_map_end - _map_begin - 1)*BlockSize)
+		_release_block(_map[--_map_end]);
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::push_front(BlockDeque<T, BlockSize>::const_reference value)
+{
+	emplace_front(value);
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::push_front(BlockDeque<T, BlockSize>::value_type&& value)
+{
+	emplace_front(std::move(value));
+}
+
+template<typename T, std::size_t BlockSize>
+template<typename... TArgs>
+typename BlockDeque<T, BlockSize>::reference BlockDeque<T, BlockSize>::emplace_front(
+	TArgs&&... args)
+{
+	if (_start == 0) 
+		_push_block_front();
+	_allocator_traits::construct(_alloc, &_get(-1), std::forward<TArgs>(args)...);
+	--_start;
+	++_size;
+	return front();
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::pop_front()
+{
+	//behaviour on empty containers is undefined, just as it is in STL
+	_allocator_traits::destroy(_alloc, &front());
+	++_start;
+	--_size;
+	if (_start >= BlockSize)
+	{
+		_release_block(_map[_map_begin++]);
+		_start -= BlockSize;
+	}
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::reference BlockDeque<T, BlockSize>::back()
+{
+	return _get(_size - 1);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_reference BlockDeque<T, BlockSize>::back() const
+{
+	return _get(_size - 1);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::reference BlockDeque<T, BlockSize>::front()
+{
+	return _get(0);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_reference BlockDeque<T, BlockSize>::front() const
+{
+	return _get(0);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::iterator BlockDeque<T, BlockSize>::begin()
+{
+	return iterator(this, 0);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_iterator BlockDeque<T, BlockSize>::begin() const
+{
+	return const_iterator(this, 0);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_iterator BlockDeque<T, BlockSize>::cbegin() const
+{
+	return const_iterator(this, 0);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::iterator BlockDeque<T, BlockSize>::end()
+{
+	return iterator(this, _size);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_iterator BlockDeque<T, BlockSize>::end() const
+{
+	return const_iterator(this, _size);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_iterator BlockDeque<T, BlockSize>::cend() const
+{
+	return const_iterator(this, _size);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::reverse_iterator BlockDeque<T, BlockSize>::rbegin()
+{
+	return reverse_iterator(end());
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_reverse_iterator BlockDeque<T, BlockSize>::rbegin() const
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_reverse_iterator BlockDeque<T, BlockSize>::crbegin() const
+{
+	return const_reverse_iterator(cend());
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::reverse_iterator BlockDeque<T, BlockSize>::rend()
+{
+	return reverse_iterator(begin());
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_reverse_iterator BlockDeque<T, BlockSize>::rend() const
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::const_reverse_iterator BlockDeque<T, BlockSize>::crend() const
+{
+	return const_reverse_iterator(cbegin());
+}
+
+template<typename T, std::size_t BlockSize>
+BlockDeque<T, BlockSize>::~BlockDeque()
+{
+	clear();
+	if (_spare != nullptr) 
+		_allocator_traits::deallocate(_alloc, _spare, BlockSize);
+	if (_map != nullptr) 
+		_map_allocator_traits::deallocate(_map_alloc, _map, _map_size);
+}
+
+template<typename T, std::size_t BlockSize>
+typename BlockDeque<T, BlockSize>::reference BlockDeque<T, BlockSize>::_get(
+	difference_type index) const
+{
+	size_type position = _start + index;
+	return _map[_map_begin + position/BlockSize][position%BlockSize];
+}
+
+template<typename T, std::size_t BlockSize>
+T* BlockDeque<T, BlockSize>::_acquire_block()
+{
+	if (_spare == nullptr) 
+		return _allocator_traits::allocate(_alloc, BlockSize);
+	T* block = _spare;
+	_spare = nullptr;
+	return block;
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::_release_block(T* block)
+{
+	if (_spare == nullptr) 
+		_spare = block;
+	else
+		_allocator_traits::deallocate(_alloc, block, BlockSize);
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::_push_block_back()
+{
+	if (_map_end == _map_size) 
+		_make_map_room();
+	_map[_map_end] = _acquire_block();
+	++_map_end;
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::_push_block_front()
+{
+	if (_map_begin == 0) 
+		_make_map_room();
+	_map[_map_begin - 1] = _acquire_block();
+	--_map_begin;
+	_start += BlockSize;
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::_make_map_room()
+{
+	//recenters the used blocks, so that both ends get free slots.
+	//the map only holds pointers, so this copies size/BlockSize words at most
+	size_type used = _map_end - _map_begin;
+	if (2*(used + 1) > _map_size)
+	{
+		_remap(2*_map_size < MIN_MAP_SIZE ? MIN_MAP_SIZE : 2*_map_size);
+		return;
+	}
+
+	size_type begin = (_map_size - used)/2;
+	std::memmove(_map + begin, _map + _map_begin, used*sizeof(T*));
+	_map_begin = begin;
+	_map_end = begin + used;
+}
+
+template<typename T, std::size_t BlockSize>
+void BlockDeque<T, BlockSize>::_remap(BlockDeque<T, BlockSize>::size_type size)
+{
+	size_type used = _map_end - _map_begin;
+	T** map = _map_allocator_traits::allocate(_map_alloc, size);
+	size_type begin = (size - used)/2;
+	if (used > 0) 
+		std::memcpy(map + begin, _map + _map_begin, used*sizeof(T*));
+	if (_map != nullptr) 
+		_map_allocator_traits::deallocate(_map_alloc, _map, _map_size);
+
+	_map = map;
+	_map_size = size;
+	_map_begin = begin;
+	_map_end = begin + used;
+}
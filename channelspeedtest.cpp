@@ -0,0 +1,180 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "deque.hpp"
+#include "deque_channel.hpp"
+#include "benchmark.hpp"
+
+
+const int ROUND_TRIPS = 200000;
+
+//the usual blocking wrapper: a Deque, a mutex and a condition variable for pops
+template<typename T>
+class CondvarDeque
+{
+public:
+	void push(const T& value)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_items.push_back(value);
+		}
+		_readable.notify_one();
+	}
+
+	void pop(T& value)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (_items.empty())
+			_readable.wait(lock);
+		value = _items.front();
+		_items.pop_front();
+	}
+
+private:
+	std::mutex _mutex;
+	std::condition_variable _readable;
+	Deque<T> _items;
+};
+
+//a ball sent over one queue and returned over the other, between two threads
+double CondvarPingPong()
+{
+	CondvarDeque<int> ping;
+	CondvarDeque<int> pong;
+	std::thread partner([&]()
+	{
+		int ball;
+		for (int i = 0; i < ROUND_TRIPS; ++i)
+		{
+			ping.pop(ball);
+			pong.push(ball + 1);
+		}
+	});
+
+	bench_clock_t::time_point start(bench_clock_t::now());
+	int ball = 0;
+	for (int i = 0; i < ROUND_TRIPS; ++i)
+	{
+		ping.push(ball);
+		pong.pop(ball);
+	}
+	double elapsed = double(ElapsedNs(start, bench_clock_t::now()));
+	partner.join();
+	if (ball != ROUND_TRIPS) std::cout << "lost the ball" << std::endl;
+	return elapsed/ROUND_TRIPS;
+}
+
+double ChannelPingPong(std::size_t capacity)
+{
+	DequeChannel<int> ping(capacity);
+	DequeChannel<int> pong(capacity);
+	std::thread partner([&]()
+	{
+		int ball;
+		for (int i = 0; i < ROUND_TRIPS; ++i)
+		{
+			ping.pop_wait(ball);
+			pong.push_wait(ball + 1);
+		}
+	});
+
+	bench_clock_t::time_point start(bench_clock_t::now());
+	int ball = 0;
+	for (int i = 0; i < ROUND_TRIPS; ++i)
+	{
+		ping.push_wait(ball);
+		pong.pop_wait(ball);
+	}
+	double elapsed = double(ElapsedNs(start, bench_clock_t::now()));
+	partner.join();
+	if (ball != ROUND_TRIPS) std::cout << "lost the ball" << std::endl;
+	return elapsed/ROUND_TRIPS;
+}
+
+#if DEQUE_COROUTINES
+//starts eagerly and frees itself when done
+struct Detached
+{
+	struct promise_type
+	{
+		Detached get_return_object() { return Detached(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+Detached Returner(DequeChannel<int>& ping, DequeChannel<int>& pong)
+{
+	for (int i = 0; i < ROUND_TRIPS; ++i)
+		co_await pong.push(co_await ping.pop() + 1);
+}
+
+Detached Server(DequeChannel<int>& ping, DequeChannel<int>& pong, int& ball)
+{
+	for (int i = 0; i < ROUND_TRIPS; ++i)
+	{
+		co_await ping.push(ball);
+		ball = co_await pong.pop();
+	}
+}
+
+//both sides are coroutines on one thread, so a round trip is two handoffs
+//and two resumptions with no kernel involved
+double CoroutinePingPong(std::size_t capacity)
+{
+	DequeChannel<int> ping(capacity);
+	DequeChannel<int> pong(capacity);
+	int ball = 0;
+	bench_clock_t::time_point start(bench_clock_t::now());
+	Returner(ping, pong);
+	Server(ping, pong, ball);
+	double elapsed = double(ElapsedNs(start, bench_clock_t::now()));
+	if (ball != ROUND_TRIPS) std::cout << "lost the ball" << std::endl;
+	return elapsed/ROUND_TRIPS;
+}
+
+//a coroutine answering a thread: it is resumed on the thread's pushes
+double MixedPingPong()
+{
+	DequeChannel<int> ping(1);
+	DequeChannel<int> pong(1);
+	Returner(ping, pong);
+
+	bench_clock_t::time_point start(bench_clock_t::now());
+	int ball = 0;
+	std::thread server([&]()
+	{
+		for (int i = 0; i < ROUND_TRIPS; ++i)
+		{
+			ping.push_wait(ball);
+			pong.pop_wait(ball);
+		}
+	});
+	server.join();
+	double elapsed = double(ElapsedNs(start, bench_clock_t::now()));
+	if (ball != ROUND_TRIPS) std::cout << "lost the ball" << std::endl;
+	return elapsed/ROUND_TRIPS;
+}
+#endif
+
+int main()
+{
+	std::cout << "Ping-pong of " << ROUND_TRIPS << " round trips on "
+		<< std::thread::hardware_concurrency() << " hardware threads..." << std::endl;
+	std::cout << "condition_variable around Deque, two threads: " << CondvarPingPong() << "ns per round trip" << std::endl;
+	std::cout << "DequeChannel, two threads: " << ChannelPingPong(1) << "ns per round trip" << std::endl;
+	std::cout << "DequeChannel without buffer, two threads: " << ChannelPingPong(0) << "ns per round trip" << std::endl;
+#if DEQUE_COROUTINES
+	std::cout << "DequeChannel, two coroutines: " << CoroutinePingPong(1) << "ns per round trip" << std::endl;
+	std::cout << "DequeChannel without buffer, two coroutines: " << CoroutinePingPong(0) << "ns per round trip" << std::endl;
+	std::cout << "DequeChannel, thread and coroutine: " << MixedPingPong() << "ns per round trip" << std::endl;
+#else
+	std::cout << "(build with C++20 for the coroutine rows)" << std::endl;
+#endif
+	return 0;
+}
@@ -0,0 +1,132 @@
+#ifndef COMPACT_DEQUE_HPP
+#define COMPACT_DEQUE_HPP
+
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "deque.hpp"
+
+
+//ring buffer deque for programs that keep millions of small deques around.
+//the object is a pointer and two 32-bit words: the size, and the start with
+//the log2 of the power of two capacity packed on top of it. the buffer is only
+//allocated by the first push and given back by clear and shrink_to_fit, so an
+//empty deque holds no heap at all. the price is a limit of MAX_CAPACITY elements.
+template<typename T>
+class CompactDeque
+{
+public:
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+
+	using value_type = T;
+	using reference = value_type&;
+	using pointer = value_type*;
+
+	using const_value_type = const T;
+	using const_reference = const value_type&;
+	using const_pointer = const value_type*;
+
+	using iterator = _ring_iterator<T>;
+	using const_iterator = _ring_iterator<const T>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	static const size_type MAX_CAPACITY = size_type(1) << 27;
+
+	CompactDeque();
+	CompactDeque(const CompactDeque<T>&);
+	CompactDeque(CompactDeque<T>&&) noexcept;
+
+	bool empty() const;
+	size_type size() const;
+	size_type capacity() const;
+	//bytes of buffer taken from the allocator
+	size_type memory_usage() const;
+
+	void clear();
+	void reserve(size_type);
+	void shrink_to_fit();
+
+	reference operator[](difference_type);
+	const_reference operator[](difference_type) const;
+
+	CompactDeque<T>& operator=(const CompactDeque<T>&);
+	CompactDeque<T>& operator=(CompactDeque<T>&&) noexcept;
+
+	void swap(CompactDeque<T>&) noexcept;
+
+	void push_back(const_reference);
+	void push_back(value_type&&);
+	template<typename... TArgs>
+	reference emplace_back(TArgs&&...);
+	void pop_back();
+
+	void push_front(const_reference);
+	void push_front(value_type&&);
+	template<typename... TArgs>
+	reference emplace_front(TArgs&&...);
+	void pop_front();
+
+	reference back();
+	const_reference back() const;
+
+	reference front();
+	const_reference front() const;
+
+	iterator begin();
+	const_iterator begin() const;
+	const_iterator cbegin() const;
+
+	iterator end();
+	const_iterator end() const;
+	const_iterator cend() const;
+
+	reverse_iterator rbegin();
+	const_reverse_iterator rbegin() const;
+	const_reverse_iterator crbegin() const;
+
+	reverse_iterator rend();
+	const_reverse_iterator rend() const;
+	const_reverse_iterator crend() const;
+
+	~CompactDeque();
+
+private:
+	using _allocator_type = std::allocator<T>;
+	using _allocator_traits = std::allocator_traits<_allocator_type>;
+
+	size_type _index(size_type) const;
+	size_type _mask() const;
+
+	//makes room for one more element, allocating the first buffer if there is none
+	void _grow();
+	void _shrink();
+	//moves the elements to a fresh buffer of 2^log2 slots, or frees it for -1
+	void _resize(int);
+	void _relocate(T*, std::true_type);
+	void _relocate(T*, std::false_type);
+	static int _log2_for(size_type);
+
+	T* _impl;
+	std::uint32_t _size;
+	std::uint32_t _start : 27;
+	std::uint32_t _log2 : 5;
+
+	//std::allocator has no state, so one is shared instead of taking room in every deque
+	static _allocator_type _alloc;
+
+	static const int MIN_LOG2 = 2;
+	static const size_type SHRINK_THRESHOLD = 4;
+};
+
+template<typename T>
+void swap(CompactDeque<T>&, CompactDeque<T>&) noexcept;
+
+#include "compact_deque.tpp"
+
+#endif //COMPACT_DEQUE_HPP
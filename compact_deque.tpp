@@ -0,0 +1,410 @@
+#include "compact_deque.hpp"
+
+template<typename T>
+CompactDeque<T>::CompactDeque()
+	: _impl(nullptr), _size(0), _start(0), _log2(0)
+{
+
+}
+
+template<typename T>
+CompactDeque<T>::CompactDeque(const CompactDeque<T>& other)
+	: CompactDeque()
+{
+	if (other._size == 0)
+		return;
+	//the delegated constructor has finished, so a throwing push runs the destructor
+	_resize(_log2_for(other._size));
+	for (size_type i = 0; i < other._size; ++i)
+		push_back(other[i]);
+}
+
+template<typename T>
+CompactDeque<T>::CompactDeque(CompactDeque<T>&& other) noexcept
+	: CompactDeque()
+{
+	swap(other);
+}
+
+template<typename T>
+bool CompactDeque<T>::empty() const
+{
+	return _size == 0;
+}
+
+template<typename T>
+typename CompactDeque<T>::size_type CompactDeque<T>::size() const
+{
+	return _size;
+}
+
+template<typename T>
+typename CompactDeque<T>::size_type CompactDeque<T>::capacity() const
+{
+	return _impl == nullptr ? 0 : size_type(1) << _log2;
+}
+
+template<typename T>
+typename CompactDeque<T>::size_type CompactDeque<T>::memory_usage() const
+{
+	return capacity()*sizeof(T);
+}
+
+template<typename T>
+void CompactDeque<T>::clear()
+{
+	for (size_type i = 0; i < _size; ++i)
+		_allocator_traits::destroy(_alloc, _impl + _index(i));
+	_size = 0;
+	_resize(-1);
+}
+
+template<typename T>
+void CompactDeque<T>::reserve(typename CompactDeque<T>::size_type amount)
+{
+	if (amount <= capacity())
+		return;
+	if (amount > MAX_CAPACITY)
+		throw std::length_error("CompactDeque: more elements than MAX_CAPACITY");
+	_resize(_log2_for(amount));
+}
+
+template<typename T>
+void CompactDeque<T>::shrink_to_fit()
+{
+	if (_size == 0)
+		_resize(-1);
+	else if (_log2_for(_size) < int(_log2))
+		_resize(_log2_for(_size));
+}
+
+template<typename T>
+typename CompactDeque<T>::reference
+	CompactDeque<T>::operator[](CompactDeque<T>::difference_type index)
+{
+	return _impl[_index(index)];
+}
+
+template<typename T>
+typename CompactDeque<T>::const_reference
+	CompactDeque<T>::operator[](CompactDeque<T>::difference_type index) const
+{
+	return _impl[_index(index)];
+}
+
+template<typename T>
+CompactDeque<T>& CompactDeque<T>::operator=(const CompactDeque<T>& other)
+{
+	if (this == &other)
+		return *this;
+	CompactDeque<T> copy(other);
+	swap(copy);
+	return *this;
+}
+
+template<typename T>
+CompactDeque<T>& CompactDeque<T>::operator=(CompactDeque<T>&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+	CompactDeque<T> tmp(std::move(other));
+	swap(tmp);
+	return *this;
+}
+
+template<typename T>
+void CompactDeque<T>::swap(CompactDeque<T>& other) noexcept
+{
+	//bit-fields can not be bound to the references std::swap takes
+	std::swap(_impl, other._impl);
+	std::swap(_size, other._size);
+	std::uint32_t start = _start;
+	std::uint32_t log2 = _log2;
+	_start = other._start;
+	_log2 = other._log2;
+	other._start = start;
+	other._log2 = log2;
+}
+
+template<typename T>
+void CompactDeque<T>::push_back(typename CompactDeque<T>::const_reference value)
+{
+	emplace_back(value);
+}
+
+template<typename T>
+void CompactDeque<T>::push_back(typename CompactDeque<T>::value_type&& value)
+{
+	emplace_back(std::move(value));
+}
+
+template<typename T>
+template<typename... TArgs>
+typename CompactDeque<T>::reference CompactDeque<T>::emplace_back(TArgs&&... args)
+{
+	if (_size == capacity())
+	{
+		//the arguments may point into the buffer that is about to move
+		T value(std::forward<TArgs>(args)...);
+		_grow();
+		return emplace_back(std::move(value));
+	}
+
+	T* slot = _impl + _index(_size);
+	_allocator_traits::construct(_alloc, slot, std::forward<TArgs>(args)...);
+	++_size;
+	return *slot;
+}
+
+template<typename T>
+void CompactDeque<T>::pop_back()
+{
+	_allocator_traits::destroy(_alloc, _impl + _index(_size - 1));
+	--_size;
+	_shrink();
+}
+
+template<typename T>
+void CompactDeque<T>::push_front(typename CompactDeque<T>::const_reference value)
+{
+	emplace_front(value);
+}
+
+template<typename T>
+void CompactDeque<T>::push_front(typename CompactDeque<T>::value_type&& value)
+{
+	emplace_front(std::move(value));
+}
+
+template<typename T>
+template<typename... TArgs>
+typename CompactDeque<T>::reference CompactDeque<T>::emplace_front(TArgs&&... args)
+{
+	if (_size == capacity())
+	{
+		T value(std::forward<TArgs>(args)...);
+		_grow();
+		return emplace_front(std::move(value));
+	}
+
+	size_type start = (_start + _mask()) & _mask();
+	T* slot = _impl + start;
+	_allocator_traits::construct(_alloc, slot, std::forward<TArgs>(args)...);
+	_start = start;
+	++_size;
+	return *slot;
+}
+
+template<typename T>
+void CompactDeque<T>::pop_front()
+{
+	_allocator_traits::destroy(_alloc, _impl + _start);
+	_start = (_start + 1) & _mask();
+	--_size;
+	_shrink();
+}
+
+template<typename T>
+typename CompactDeque<T>::reference CompactDeque<T>::back()
+{
+	return (*this)[_size - 1];
+}
+
+template<typename T>
+typename CompactDeque<T>::const_reference CompactDeque<T>::back() const
+{
+	return (*this)[_size - 1];
+}
+
+template<typename T>
+typename CompactDeque<T>::reference CompactDeque<T>::front()
+{
+	return _impl[_start];
+}
+
+template<typename T>
+typename CompactDeque<T>::const_reference CompactDeque<T>::front() const
+{
+	return _impl[_start];
+}
+
+template<typename T>
+typename CompactDeque<T>::iterator CompactDeque<T>::begin()
+{
+	return iterator(_impl, capacity(), _impl == nullptr ? 0 : _start, 0);
+}
+
+template<typename T>
+typename CompactDeque<T>::const_iterator CompactDeque<T>::begin() const
+{
+	return const_iterator(_impl, capacity(), _impl == nullptr ? 0 : _start, 0);
+}
+
+template<typename T>
+typename CompactDeque<T>::const_iterator CompactDeque<T>::cbegin() const
+{
+	return begin();
+}
+
+template<typename T>
+typename CompactDeque<T>::iterator CompactDeque<T>::end()
+{
+	return iterator(_impl, capacity(), _impl == nullptr ? 0 : _index(_size), _size);
+}
+
+template<typename T>
+typename CompactDeque<T>::const_iterator CompactDeque<T>::end() const
+{
+	return const_iterator(_impl, capacity(), _impl == nullptr ? 0 : _index(_size), _size);
+}
+
+template<typename T>
+typename CompactDeque<T>::const_iterator CompactDeque<T>::cend() const
+{
+	return end();
+}
+
+template<typename T>
+typename CompactDeque<T>::reverse_iterator CompactDeque<T>::rbegin()
+{
+	return reverse_iterator(end());
+}
+
+template<typename T>
+typename CompactDeque<T>::const_reverse_iterator CompactDeque<T>::rbegin() const
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename T>
+typename CompactDeque<T>::const_reverse_iterator CompactDeque<T>::crbegin() const
+{
+	return rbegin();
+}
+
+template<typename T>
+typename CompactDeque<T>::reverse_iterator CompactDeque<T>::rend()
+{
+	return reverse_iterator(begin());
+}
+
+template<typename T>
+typename CompactDeque<T>::const_reverse_iterator CompactDeque<T>::rend() const
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename T>
+typename CompactDeque<T>::const_reverse_iterator CompactDeque<T>::crend() const
+{
+	return rend();
+}
+
+template<typename T>
+CompactDeque<T>::~CompactDeque()
+{
+	clear();
+}
+
+template<typename T>
+typename CompactDeque<T>::_allocator_type CompactDeque<T>::_alloc;
+
+template<typename T>
+typename CompactDeque<T>::size_type CompactDeque<T>::_index(typename CompactDeque<T>::size_type index) const
+{
+	return (_start + index) & _mask();
+}
+
+template<typename T>
+typename CompactDeque<T>::size_type CompactDeque<T>::_mask() const
+{
+	return (size_type(1) << _log2) - 1;
+}
+
+template<typename T>
+void CompactDeque<T>::_grow()
+{
+	if (_impl == nullptr)
+		_resize(MIN_LOG2);
+	else if (capacity() == MAX_CAPACITY)
+		throw std::length_error("CompactDeque: more elements than MAX_CAPACITY");
+	else
+		_resize(_log2 + 1);
+}
+
+template<typename T>
+void CompactDeque<T>::_shrink()
+{
+	if (int(_log2) > MIN_LOG2 && SHRINK_THRESHOLD*_size <= capacity())
+		_resize(_log2_for(2*_size));
+}
+
+template<typename T>
+void CompactDeque<T>::_resize(int log2)
+{
+	T* buffer = nullptr;
+	if (log2 >= 0)
+	{
+		buffer = _allocator_traits::allocate(_alloc, size_type(1) << log2);
+		try
+		{
+			_relocate(buffer, std::is_trivially_copyable<T>());
+		}
+		catch (...)
+		{
+			_allocator_traits::deallocate(_alloc, buffer, size_type(1) << log2);
+			throw;
+		}
+	}
+	if (_impl != nullptr)
+		_allocator_traits::deallocate(_alloc, _impl, capacity());
+
+	_impl = buffer;
+	_start = 0;
+	_log2 = log2 < 0 ? 0 : log2;
+}
+
+template<typename T>
+void CompactDeque<T>::_relocate(T* buffer, std::true_type)
+{
+	if (_size == 0)
+		return;
+	size_type first = capacity() - _start < _size ? capacity() - _start : _size;
+	std::memcpy(static_cast<void*>(buffer), _impl + _start, first*sizeof(T));
+	std::memcpy(static_cast<void*>(buffer + first), _impl, (_size - first)*sizeof(T));
+}
+
+template<typename T>
+void CompactDeque<T>::_relocate(T* buffer, std::false_type)
+{
+	size_type moved = 0;
+	try
+	{
+		for (; moved < _size; ++moved)
+			_allocator_traits::construct(_alloc, buffer + moved,
+				std::move_if_noexcept(_impl[_index(moved)]));
+	}
+	catch (...)
+	{
+		for (size_type i = 0; i < moved; ++i)
+			_allocator_traits::destroy(_alloc, buffer + i);
+		throw;
+	}
+	for (size_type i = 0; i < _size; ++i)
+		_allocator_traits::destroy(_alloc, _impl + _index(i));
+}
+
+template<typename T>
+int CompactDeque<T>::_log2_for(typename CompactDeque<T>::size_type count)
+{
+	int result = MIN_LOG2;
+	while ((size_type(1) << result) < count)
+		++result;
+	return result;
+}
+
+template<typename T>
+void swap(CompactDeque<T>& a, CompactDeque<T>& b) noexcept
+{
+	a.swap(b);
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "deque.hpp"
+#include "compact_deque.hpp"
+
+
+const std::size_t DEQUES = 1000000;
+
+//resident set size of this process, from the second field of /proc/self/statm
+std::size_t ResidentBytes()
+{
+	std::ifstream statm("/proc/self/statm");
+	std::size_t total = 0;
+	std::size_t resident = 0;
+	statm >> total >> resident;
+	return resident*sysconf(_SC_PAGESIZE);
+}
+
+template<typename TDeque>
+std::size_t HeapBytes(const TDeque& deq)
+{
+	return deq.memory_usage();
+}
+
+template<typename T>
+std::size_t HeapBytes(const std::deque<T>&)
+{
+	return 0;
+}
+
+//a million deques holding elements each, the RSS they add and the
+//buffer bytes they report holding
+template<typename TDeque>
+void Measure(const std::string& name, std::size_t elements)
+{
+	std::size_t before = ResidentBytes();
+	std::vector<TDeque> deques(DEQUES);
+	for (TDeque& deq : deques)
+		for (std::size_t i = 0; i < elements; ++i)
+			deq.push_back(int(i));
+	std::size_t after = ResidentBytes();
+
+	std::size_t reported = 0;
+	for (const TDeque& deq : deques)
+		reported += HeapBytes(deq);
+
+	std::cout << name << ", " << elements << " elements: "
+		<< (after - before)/1048576.0 << "MB RSS per million, "
+		<< (after - before)/double(DEQUES) << " bytes each (object " << sizeof(TDeque) << ", memory_usage "
+		<< reported/double(DEQUES) << ")" << std::endl;
+}
+
+//every measurement runs in a child of its own, as the allocator keeps
+//freed pages mapped and the next one would reuse them for free
+template<typename TDeque>
+void Report(const std::string& name, std::size_t elements)
+{
+	std::cout.flush();
+	pid_t child = fork();
+	if (child == 0)
+	{
+		Measure<TDeque>(name, elements);
+		std::cout.flush();
+		std::_Exit(0);
+	}
+	int status = 0;
+	waitpid(child, &status, 0);
+}
+
+int main()
+{
+	std::cout << "Memory held by " << DEQUES << " deques of int..." << std::endl;
+	for (std::size_t elements : {0, 1, 3, 8})
+	{
+		Report<std::deque<int>>("std::deque", elements);
+		Report<Deque<int>>("Deque", elements);
+		Report<SmallDeque<int, 4>>("SmallDeque<4>", elements);
+		Report<CompactDeque<int>>("CompactDeque", elements);
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -4,92 +4,436 @@
 #define DEQUE_HPP
 
 #include <iterator>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <type_traits>
 #include <cstring>
 #include <cstddef>
+#include <stdexcept>
+#include <functional>
+
+//under C++20 the whole Deque is usable in constant expressions, unless DEQUE_STATS
+//puts a std::function into it. the memcpy and memmove fast paths step aside 
+//while the compiler evaluates it
+#if __cplusplus >= 202002L
+#define DEQUE_CONSTEXPR constexpr
+#define DEQUE_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define DEQUE_CONSTEXPR
+#define DEQUE_CONSTANT_EVALUATED() false
+#endif
 
 
 template<typename TContainerPtr>
 class _iterator_base;
 
-template<typename T>
-class Deque
+template<typename TValue>
+class _ring_iterator;
+
+//growth policies decide how the capacity of the ring buffer evolves:
+//a full buffer is multiplied by GrowthFactor, and once size*ShrinkThreshold 
+//drops to the capacity it is shrunk back to GrowthFactor*size.
+//ShrinkThreshold of 0 disables automatic shrinking.
+//PowerOfTwo keeps the capacity a power of two, so that indexing is a single mask
+template<std::size_t GrowthFactor = 2, std::size_t ShrinkThreshold = 4, 
+	std::size_t MinCapacity = 8, bool PowerOfTwo = false>
+struct GrowthPolicy
 {
-public:
-	using size_type = std::size_t;
-	using difference_type = std::ptrdiff_t;
-
-	using value_type = T;
-	using reference = value_type&;
-	using pointer = value_type*;
+	static const std::size_t GROWTH_FACTOR = GrowthFactor;
+	static const std::size_t SHRINK_THRESHOLD = ShrinkThreshold;
+	static const std::size_t MIN_CAPACITY = MinCapacity;
+	static const bool POWER_OF_TWO = PowerOfTwo;
+	static const bool FIXED = false;
+};
 
-	using const_value_type = const T;
-	using const_reference = const value_type&;
-	using const_pointer = const value_type*;
+//a bounded ring of exactly Capacity elements that never reallocates:
+//growing past it throws std::length_error, push_back_overwrite drops the oldest
+//element instead. the capacity is a constant, so indexing needs no load of it
+template<std::size_t Capacity>
+struct FixedCapacity
+{
+	static const std::size_t GROWTH_FACTOR = 2;
+	static const std::size_t SHRINK_THRESHOLD = 0;
+	static const std::size_t MIN_CAPACITY = Capacity;
+	static const bool POWER_OF_TWO = (Capacity & (Capacity - 1)) == 0;
+	static const bool FIXED = true;
+};
 
-	using iterator = _iterator_base<Deque<T>*>;
-	using const_iterator = _iterator_base<const Deque<T>*>;
-	using reverse_iterator = std::reverse_iterator<iterator>;
-	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+using DefaultGrowthPolicy = GrowthPolicy<>;
+using PowerOfTwoGrowthPolicy = GrowthPolicy<2, 4, 8, true>;
+using NoShrinkGrowthPolicy = GrowthPolicy<2, 0>;
 
-	Deque();
-	Deque(const Deque<T>&);
+//a contiguous run of elements inside a deque's buffer
+template<typename TPointer>
+struct DequeSpan
+{
+	TPointer data;
+	std::size_t size;
 
-	bool empty() const;
-	size_type size() const;
-	size_type capacity() const;
+	TPointer begin() const { return data; }
+	TPointer end() const { return data + size; }
+};
 
-	void clear();
-	void reserve(size_type);
+//one command of a batch for Deque::apply, index is only read by IndexSet
+enum class DequeOpType
+{
+	PushBack,
+	PushFront,
+	PopBack,
+	PopFront,
+	IndexSet
+};
 
-	reference operator[](difference_type);
-	const_reference operator[](difference_type) const;
+template<typename T>
+struct DequeOp
+{
+	DequeOpType type;
+	std::size_t index;
+	T value;
+};
 
-	Deque<T>& operator=(const Deque<T>&);
+//counters kept by a deque compiled with DEQUE_STATS defined. without it
+//the counting compiles away and Deque has neither stats() nor the resize hook
+struct DequeStats
+{
+	std::size_t push_back;
+	std::size_t push_front;
+	std::size_t pop_back;
+	std::size_t pop_front;
+	std::size_t grows;
+	std::size_t shrinks;
+	std::size_t bytes_copied;
+	std::size_t peak_size;
+	std::size_t peak_capacity;
+};
 
-	void push_back(const_reference);
-	void pop_back();
+//passed to the resize hook once before a resize and once after it completes
+struct DequeResizeEvent
+{
+	std::size_t size;
+	std::size_t old_capacity;
+	std::size_t new_capacity;
+	bool finished;
+};
 
-	void push_front(const_reference);
-	void pop_front();
+//storage for the first few elements inside the deque object itself
+template<typename T, std::size_t Capacity>
+class _inline_buffer
+{
+protected:
+	T* _inline_data() { return reinterpret_cast<T*>(&_storage); }
+	const T* _inline_data() const { return reinterpret_cast<const T*>(&_storage); }
 
-	reference back();
-	const_reference back() const;
+private:
+	typename std::aligned_storage<Capacity*sizeof(T), alignof(T)>::type _storage;
+};
 
-	reference front();
-	const_reference front() const;
+template<typename T>
+class _inline_buffer<T, 0>
+{
+protected:
+	DEQUE_CONSTEXPR T* _inline_data() { return nullptr; }
+	DEQUE_CONSTEXPR const T* _inline_data() const { return nullptr; }
+};
 
-	iterator begin();
-	const_iterator begin() const;
-	const_iterator cbegin() const;
+//InlineCapacity > 0 keeps the ring inside the object until it outgrows
+//that many elements, so small deques never touch the allocator
+template<typename T, typename TGrowthPolicy = DefaultGrowthPolicy, 
+	typename TAllocator = std::allocator<T>, std::size_t InlineCapacity = 0>
+class Deque : private _inline_buffer<T, InlineCapacity>
+{
+public:
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
 
-	iterator end();
-	const_iterator end() const;
-	const_iterator cend() const;
+	using value_type = T;
+	using reference = value_type&;
+	using pointer = value_type*;
 
-	reverse_iterator rbegin();
-	const_reverse_iterator rbegin() const;
-	const_reverse_iterator crbegin() const;
+	using const_value_type = const T;
+	using const_reference = const value_type&;
+	using const_pointer = const value_type*;
 
-	reverse_iterator rend();
-	const_reverse_iterator rend() const;
-	const_reverse_iterator crend() const;
+	using iterator = _ring_iterator<T>;
+	using const_iterator = _ring_iterator<const T>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-	~Deque();
+	using span_type = DequeSpan<pointer>;
+	using const_span_type = DequeSpan<const_pointer>;
+
+	using allocator_type = TAllocator;
+
+	DEQUE_CONSTEXPR Deque();
+	explicit DEQUE_CONSTEXPR Deque(const allocator_type&);
+	DEQUE_CONSTEXPR Deque(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&);
+	DEQUE_CONSTEXPR Deque(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&, const allocator_type&);
+	DEQUE_CONSTEXPR Deque(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&&) 
+		noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value);
+	DEQUE_CONSTEXPR Deque(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&&, const allocator_type&);
+
+	DEQUE_CONSTEXPR allocator_type get_allocator() const;
+
+	DEQUE_CONSTEXPR bool empty() const;
+	DEQUE_CONSTEXPR size_type size() const;
+	DEQUE_CONSTEXPR size_type capacity() const;
+	//bytes of buffer taken from the allocator, 0 while the ring is inline
+	DEQUE_CONSTEXPR size_type memory_usage() const;
+
+	DEQUE_CONSTEXPR void clear();
+	DEQUE_CONSTEXPR void reserve(size_type);
+	DEQUE_CONSTEXPR void shrink_to_fit();
+
+	//number of reallocations done so far, for profiling growth policies
+	DEQUE_CONSTEXPR size_type grow_count() const;
+	DEQUE_CONSTEXPR size_type shrink_count() const;
+
+#ifdef DEQUE_STATS
+	using resize_hook_type = std::function<void(const DequeResizeEvent&)>;
+
+	DequeStats stats() const;
+	void reset_stats();
+	void set_resize_hook(resize_hook_type);
+#endif
+
+	DEQUE_CONSTEXPR reference operator[](difference_type);
+	DEQUE_CONSTEXPR const_reference operator[](difference_type) const;
+
+	DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& operator=(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&);
+	DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& operator=(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&&) 
+		noexcept(std::allocator_traits<TAllocator>::propagate_on_container_move_assignment::value
+			&& (InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value));
+
+	DEQUE_CONSTEXPR void swap(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&) 
+		noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value);
+
+	DEQUE_CONSTEXPR void push_back(const_reference);
+	DEQUE_CONSTEXPR void push_back(value_type&&);
+	template<typename... TArgs>
+	DEQUE_CONSTEXPR reference emplace_back(TArgs&&...);
+	DEQUE_CONSTEXPR void pop_back();
+
+	//when the buffer is full these drop the front element instead of growing
+	DEQUE_CONSTEXPR void push_back_overwrite(const_reference);
+	DEQUE_CONSTEXPR void push_back_overwrite(value_type&&);
+	template<typename... TArgs>
+	DEQUE_CONSTEXPR reference emplace_back_overwrite(TArgs&&...);
+
+	DEQUE_CONSTEXPR void push_front(const_reference);
+	DEQUE_CONSTEXPR void push_front(value_type&&);
+	template<typename... TArgs>
+	DEQUE_CONSTEXPR reference emplace_front(TArgs&&...);
+	DEQUE_CONSTEXPR void pop_front();
+
+	//bulk operations size the buffer once and copy at most two spans of the ring
+	template<typename TInputIt>
+	DEQUE_CONSTEXPR void append(TInputIt, TInputIt);
+	template<typename TInputIt>
+	DEQUE_CONSTEXPR void prepend(TInputIt, TInputIt);
+	DEQUE_CONSTEXPR void pop_back_n(size_type);
+	DEQUE_CONSTEXPR void pop_front_n(size_type);
+
+	//inserting or erasing in the middle shifts whichever side is shorter
+	DEQUE_CONSTEXPR iterator insert(const_iterator, const_reference);
+	DEQUE_CONSTEXPR iterator insert(const_iterator, value_type&&);
+	template<typename TInputIt>
+	DEQUE_CONSTEXPR iterator insert(const_iterator, TInputIt, TInputIt);
+	template<typename... TArgs>
+	DEQUE_CONSTEXPR iterator emplace(const_iterator, TArgs&&...);
+
+	DEQUE_CONSTEXPR iterator erase(const_iterator);
+	DEQUE_CONSTEXPR iterator erase(const_iterator, const_iterator);
+
+	//ordered operations: everything but sort expects the deque to be sorted by the 
+	//same comparator already. the searches binary-search one run of the ring directly,
+	//insert_sorted and merge keep equal elements in insertion order
+	template<typename TCompare = std::less<T>>
+	DEQUE_CONSTEXPR void sort(TCompare = TCompare());
+	template<typename TCompare = std::less<T>>
+	DEQUE_CONSTEXPR iterator lower_bound(const_reference, TCompare = TCompare());
+	template<typename TCompare = std::less<T>>
+	DEQUE_CONSTEXPR const_iterator lower_bound(const_reference, TCompare = TCompare()) const;
+	template<typename TCompare = std::less<T>>
+	DEQUE_CONSTEXPR iterator upper_bound(const_reference, TCompare = TCompare());
+	template<typename TCompare = std::less<T>>
+	DEQUE_CONSTEXPR const_iterator upper_bound(const_reference, TCompare = TCompare()) const;
+	template<typename TCompare = std::less<T>>
+	DEQUE_CONSTEXPR iterator insert_sorted(const_reference, TCompare = TCompare());
+	template<typename TCompare = std::less<T>>
+	DEQUE_CONSTEXPR iterator insert_sorted(value_type&&, TCompare = TCompare());
+	//merges a sorted range in, shifting only the shorter side of the part it overlaps
+	template<typename TInputIt, typename TCompare = std::less<T>>
+	DEQUE_CONSTEXPR void merge(TInputIt, TInputIt, TCompare = TCompare());
+
+	//runs a batch of DequeOp<T> in order. the batch is checked and its peak size found first,
+	//so the buffer grows at most once and a batch that pops an empty deque or indexes
+	//past the end throws std::out_of_range before changing anything.
+	//trivially copyable elements are then replayed without branching on the operations,
+	//others by runs on one end, where pushes that the pops right after them take back 
+	//are never constructed
+	template<typename TRandomIt>
+	DEQUE_CONSTEXPR void apply(TRandomIt, TRandomIt);
+	template<typename TBatch>
+	DEQUE_CONSTEXPR void apply(const TBatch&);
+
+	//the contents as at most two contiguous runs, the second one is empty 
+	//unless the ring wraps around. valid until the next modification
+	DEQUE_CONSTEXPR std::pair<span_type, span_type> as_spans();
+	DEQUE_CONSTEXPR std::pair<const_span_type, const_span_type> as_spans() const;
+
+	//rotates the ring in place so that the contents are one run starting at the buffer
+	DEQUE_CONSTEXPR pointer linearize();
+
+	//raw storage for at least count elements right after back(), 
+	//for trivially copyable T only. commit_back makes the first count of them part of the deque
+	DEQUE_CONSTEXPR span_type reserve_back_span(size_type);
+	DEQUE_CONSTEXPR void commit_back(size_type);
+
+	DEQUE_CONSTEXPR reference back();
+	DEQUE_CONSTEXPR const_reference back() const;
+
+	DEQUE_CONSTEXPR reference front();
+	DEQUE_CONSTEXPR const_reference front() const;
+
+	DEQUE_CONSTEXPR iterator begin();
+	DEQUE_CONSTEXPR const_iterator begin() const;
+	DEQUE_CONSTEXPR const_iterator cbegin() const;
+
+	DEQUE_CONSTEXPR iterator end();
+	DEQUE_CONSTEXPR const_iterator end() const;
+	DEQUE_CONSTEXPR const_iterator cend() const;
+
+	DEQUE_CONSTEXPR reverse_iterator rbegin();
+	DEQUE_CONSTEXPR const_reverse_iterator rbegin() const;
+	DEQUE_CONSTEXPR const_reverse_iterator crbegin() const;
+
+	DEQUE_CONSTEXPR reverse_iterator rend();
+	DEQUE_CONSTEXPR const_reverse_iterator rend() const;
+	DEQUE_CONSTEXPR const_reverse_iterator crend() const;
+
+	DEQUE_CONSTEXPR ~Deque();
 
 private:
-	void _normalize();
-	void _resize(size_type);
-	reference _get(difference_type) const;
-
+	using _allocator_type = TAllocator;
+	using _allocator_traits = std::allocator_traits<_allocator_type>;
+
+	DEQUE_CONSTEXPR void _count(size_type DequeStats::*, size_type);
+
+	DEQUE_CONSTEXPR void _swap_storage(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&) 
+		noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value);
+	DEQUE_CONSTEXPR void _take_storage(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&);
+	DEQUE_CONSTEXPR void _release();
+	DEQUE_CONSTEXPR bool _is_inline(const T*) const;
+	template<typename TOther>
+	DEQUE_CONSTEXPR void _assign_allocator(TOther&&, std::true_type);
+	template<typename TOther>
+	DEQUE_CONSTEXPR void _assign_allocator(TOther&&, std::false_type);
+	DEQUE_CONSTEXPR void _swap_allocator(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&, std::true_type) noexcept;
+	DEQUE_CONSTEXPR void _swap_allocator(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&, std::false_type) noexcept;
+
+	DEQUE_CONSTEXPR void _grow();
+	DEQUE_CONSTEXPR void _reserve_extra(size_type);
+	DEQUE_CONSTEXPR void _normalize();
+	DEQUE_CONSTEXPR void _resize(size_type);
+	DEQUE_CONSTEXPR size_type _index(difference_type) const;
+	DEQUE_CONSTEXPR reference _get(difference_type) const;
+	DEQUE_CONSTEXPR iterator _make_iterator(size_type);
+	DEQUE_CONSTEXPR const_iterator _make_iterator(size_type) const;
+	static DEQUE_CONSTEXPR size_type _fit_capacity(size_type);
+	static DEQUE_CONSTEXPR size_type _initial_capacity();
+	DEQUE_CONSTEXPR size_type _ring_capacity() const;
+
+	DEQUE_CONSTEXPR T* _allocate(size_type);
+	DEQUE_CONSTEXPR void _deallocate(T*, size_type);
+	DEQUE_CONSTEXPR void _destroy_all();
+	DEQUE_CONSTEXPR void _destroy_range(size_type, size_type);
+	DEQUE_CONSTEXPR void _shift_down(size_type, size_type, size_type, std::true_type);
+	DEQUE_CONSTEXPR void _shift_down(size_type, size_type, size_type, std::false_type);
+
+	template<typename TInputIt>
+	DEQUE_CONSTEXPR void _append(TInputIt, TInputIt, std::input_iterator_tag);
+	template<typename TForwardIt>
+	DEQUE_CONSTEXPR void _append(TForwardIt, TForwardIt, std::forward_iterator_tag);
+	template<typename TInputIt>
+	DEQUE_CONSTEXPR void _prepend(TInputIt, TInputIt, std::input_iterator_tag);
+	template<typename TForwardIt>
+	DEQUE_CONSTEXPR void _prepend(TForwardIt, TForwardIt, std::forward_iterator_tag);
+	template<typename TInputIt>
+	DEQUE_CONSTEXPR iterator _insert(size_type, TInputIt, TInputIt, std::input_iterator_tag);
+	template<typename TForwardIt>
+	DEQUE_CONSTEXPR iterator _insert(size_type, TForwardIt, TForwardIt, std::forward_iterator_tag);
+
+	DEQUE_CONSTEXPR void _open_gap(size_type, size_type, bool, size_type&, size_type&);
+	DEQUE_CONSTEXPR void _move_ring(size_type, size_type, size_type, std::true_type);
+	DEQUE_CONSTEXPR void _move_ring(size_type, size_type, size_type, std::false_type);
+	template<typename TForwardIt>
+	DEQUE_CONSTEXPR void _fill_gap(size_type, size_type, size_type, size_type, TForwardIt);
+	template<typename TValue>
+	DEQUE_CONSTEXPR void _store(size_type, bool, TValue&&);
+
+	template<typename TRandomIt>
+	DEQUE_CONSTEXPR void _replay(TRandomIt, TRandomIt, std::true_type);
+	template<typename TRandomIt>
+	DEQUE_CONSTEXPR void _replay(TRandomIt, TRandomIt, std::false_type);
+	template<typename TRandomIt>
+	DEQUE_CONSTEXPR TRandomIt _apply_back(TRandomIt, TRandomIt);
+	template<typename TRandomIt>
+	DEQUE_CONSTEXPR TRandomIt _apply_front(TRandomIt, TRandomIt);
+
+	template<typename TCompare>
+	DEQUE_CONSTEXPR size_type _bound(const_reference, TCompare, bool) const;
+	template<typename TInputIt, typename TCompare>
+	DEQUE_CONSTEXPR void _merge(TInputIt, TInputIt, TCompare, std::input_iterator_tag);
+	template<typename TRandomIt, typename TCompare>
+	DEQUE_CONSTEXPR void _merge(TRandomIt, TRandomIt, TCompare, std::random_access_iterator_tag);
+	DEQUE_CONSTEXPR void _relocate(T*, T*, size_type, std::true_type);
+	DEQUE_CONSTEXPR void _relocate(T*, T*, size_type, std::false_type);
+	DEQUE_CONSTEXPR void _copy_elements(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&, std::true_type);
+	DEQUE_CONSTEXPR void _copy_elements(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&, std::false_type);
+	template<typename TForwardIt>
+	DEQUE_CONSTEXPR void _construct_copy(TForwardIt, TForwardIt, T*);
+
+	//_impl is raw memory, only the _size slots starting at _start hold live objects
 	T* _impl;
 	size_type _capacity;
 	size_type _size;
 	size_type _start;
 
-	static const size_type RESIZE_COEFF = 2;
-	static const size_type DEFAULT_SIZE = 8;
+	size_type _grows;
+	size_type _shrinks;
+
+#ifdef DEQUE_STATS
+	DequeStats _stats = DequeStats();
+	resize_hook_type _resize_hook;
+#endif
+
+	static const size_type GROWTH_FACTOR = TGrowthPolicy::GROWTH_FACTOR;
+	static const size_type SHRINK_THRESHOLD = TGrowthPolicy::SHRINK_THRESHOLD;
+	static const size_type MIN_CAPACITY = TGrowthPolicy::MIN_CAPACITY;
+
+	static_assert(GROWTH_FACTOR >= 2, "Growth factor must be at least 2");
+	static_assert(SHRINK_THRESHOLD == 0 || SHRINK_THRESHOLD > GROWTH_FACTOR, 
+		"Shrink threshold must exceed the growth factor, otherwise resizes thrash");
+	static_assert(MIN_CAPACITY > 0, "Minimal capacity must be positive");
+	static_assert(std::is_same<typename TAllocator::value_type, T>::value, 
+		"Allocator must allocate the element type");
+	static_assert(!TGrowthPolicy::POWER_OF_TWO || (InlineCapacity & (InlineCapacity - 1)) == 0,
+		"Inline capacity must be a power of two under a power of two policy");
+	static_assert(!TGrowthPolicy::FIXED || InlineCapacity == 0 || InlineCapacity == MIN_CAPACITY,
+		"Inline capacity of a fixed ring must match its capacity");
+
+	_allocator_type _alloc;
 };
 
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void swap(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&) 
+	noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value);
+
+template<typename T, std::size_t N, typename TGrowthPolicy = DefaultGrowthPolicy, 
+	typename TAllocator = std::allocator<T>>
+using SmallDeque = Deque<T, TGrowthPolicy, TAllocator, N>;
+
 
 
 
@@ -124,25 +468,25 @@ bool operator<(
 
 namespace std
 {
-	template<typename T>
-	class iterator_traits<_iterator_base<Deque<T>*>>
+	template<typename TContainer>
+	class iterator_traits<_iterator_base<TContainer*>>
 	{
 	public:
-		using difference_type = typename Deque<T>::difference_type;
-		using value_type = typename Deque<T>::value_type;
-		using pointer = typename Deque<T>::pointer;
-		using reference = typename Deque<T>::reference;
+		using difference_type = typename TContainer::difference_type;
+		using value_type = typename TContainer::value_type;
+		using pointer = typename TContainer::pointer;
+		using reference = typename TContainer::reference;
 		using iterator_category = std::random_access_iterator_tag;
 	};
 
-	template<typename T>
-	class iterator_traits<_iterator_base<const Deque<T>*>>
+	template<typename TContainer>
+	class iterator_traits<_iterator_base<const TContainer*>>
 	{
 	public:
-		using difference_type = typename Deque<T>::difference_type;
-		using value_type = typename Deque<T>::const_value_type;
-		using pointer = typename Deque<T>::const_pointer;
-		using reference = typename Deque<T>::const_reference;
+		using difference_type = typename TContainer::difference_type;
+		using value_type = typename TContainer::const_value_type;
+		using pointer = typename TContainer::const_pointer;
+		using reference = typename TContainer::const_reference;
 		using iterator_category = std::random_access_iterator_tag;
 	};
 }
@@ -167,6 +511,11 @@ public:
 
 	_iterator_base(const _iterator_base<TContainerPtr>&) = default;
 
+	//iterator converts to const_iterator, but not the other way around
+	template<typename TOtherPtr, typename = typename std::enable_if<
+		std::is_convertible<TOtherPtr, TContainerPtr>::value>::type>
+	_iterator_base(const _iterator_base<TOtherPtr>&);
+
 	_iterator_base& operator++();
 	_iterator_base operator++(int);
 	_iterator_base& operator--();
@@ -192,11 +541,78 @@ public:
 	pointer operator->();
 
 private:
+	template<typename>
+	friend class _iterator_base;
+
 	difference_type _position;
 
 	TContainerPtr _container;
 };
 
+//ring iterators point straight into the buffer and only check for the wrap
+//when stepping over the end of it, instead of going through operator[]
+template<typename TValue>
+class _ring_iterator
+{
+public:
+	using value_type = typename std::remove_const<TValue>::type;
+	using difference_type = std::ptrdiff_t;
+	using pointer = TValue*;
+	using reference = TValue&;
+	using iterator_category = std::random_access_iterator_tag;
+	using own_type = _ring_iterator<TValue>;
+
+	DEQUE_CONSTEXPR _ring_iterator();
+	DEQUE_CONSTEXPR _ring_iterator(pointer, std::size_t, std::size_t, difference_type);
+
+	_ring_iterator(const own_type&) = default;
+
+	template<typename TOther, typename = typename std::enable_if<
+		std::is_convertible<TOther*, TValue*>::value>::type>
+	DEQUE_CONSTEXPR _ring_iterator(const _ring_iterator<TOther>&);
+
+	DEQUE_CONSTEXPR own_type& operator++();
+	DEQUE_CONSTEXPR own_type operator++(int);
+	DEQUE_CONSTEXPR own_type& operator--();
+	DEQUE_CONSTEXPR own_type operator--(int);
+
+	DEQUE_CONSTEXPR own_type& operator+=(difference_type);
+	DEQUE_CONSTEXPR own_type& operator-=(difference_type);
+
+	DEQUE_CONSTEXPR own_type operator+(difference_type) const;
+	DEQUE_CONSTEXPR own_type operator-(difference_type) const;
+	DEQUE_CONSTEXPR difference_type operator-(const own_type&) const;
+
+	DEQUE_CONSTEXPR bool operator==(const own_type&) const;
+	DEQUE_CONSTEXPR bool operator!=(const own_type&) const;
+	DEQUE_CONSTEXPR bool operator<(const own_type&) const;
+	DEQUE_CONSTEXPR bool operator>(const own_type&) const;
+	DEQUE_CONSTEXPR bool operator<=(const own_type&) const;
+	DEQUE_CONSTEXPR bool operator>=(const own_type&) const;
+
+	own_type& operator=(const own_type&) = default;
+
+	DEQUE_CONSTEXPR reference operator*() const;
+	DEQUE_CONSTEXPR pointer operator->() const;
+	DEQUE_CONSTEXPR reference operator[](difference_type) const;
+
+	//how many elements are contiguous in memory starting from this one
+	DEQUE_CONSTEXPR difference_type segment_size() const;
+
+private:
+	template<typename>
+	friend class _ring_iterator;
+
+	pointer _current;
+	pointer _buffer;
+	pointer _buffer_end;
+	difference_type _position;
+};
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue> operator+(
+	typename _ring_iterator<TValue>::difference_type, const _ring_iterator<TValue>&);
+
 #include "deque.tpp"
 
 #endif //DEQUE_HPP
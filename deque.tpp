@@ -1,278 +1,1618 @@
 #include "deque.hpp"
 
-template<typename T>
-Deque<T>::Deque()
-	: _impl(new T[DEFAULT_SIZE]), _capacity(DEFAULT_SIZE), _size(0), _start(0)
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::Deque()
+	: _impl(nullptr), _capacity(_initial_capacity()), _size(0), _start(0), 
+	_grows(0), _shrinks(0)
+{
+	_impl = _allocate(_capacity);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::Deque(const allocator_type& alloc)
+	: _impl(nullptr), _capacity(_initial_capacity()), _size(0), _start(0), 
+	_grows(0), _shrinks(0), _alloc(alloc)
+{
+	_impl = _allocate(_capacity);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::Deque(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other)
+	: Deque(other, _allocator_traits::select_on_container_copy_construction(other._alloc))
+{
+
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::Deque(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other, const allocator_type& alloc)
+	: _impl(nullptr), _capacity(other._capacity), _size(0), _start(0), 
+	_grows(0), _shrinks(0), _alloc(alloc)
+{
+	_impl = _allocate(_capacity);
+	_copy_elements(other, std::is_trivially_copyable<T>());
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::Deque(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&& other) 
+	noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value)
+	: _impl(nullptr), _capacity(0), _size(0), _start(0), 
+	_grows(0), _shrinks(0), _alloc(std::move(other._alloc))
+{
+	_take_storage(other);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::Deque(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&& other, const allocator_type& alloc)
+	: _impl(nullptr), _capacity(0), _size(0), _start(0), 
+	_grows(0), _shrinks(0), _alloc(alloc)
+{
+	if (_alloc == other._alloc)
+	{
+		_take_storage(other);
+		return;
+	}
+
+	//memory from another allocator can not be adopted, only the elements move
+	_capacity = other._capacity;
+	_impl = _allocate(_capacity);
+	try
+	{
+		for (; _size < other._size; ++_size)
+			_allocator_traits::construct(_alloc, _impl + _size, std::move_if_noexcept(other[_size]));
+	}
+	catch (...)
+	{
+		_destroy_all();
+		_deallocate(_impl, _capacity);
+		throw;
+	}
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::allocator_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::get_allocator() const
+{
+	return _alloc;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR bool Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::empty() const
+{
+	return _size == 0;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size() const
+{
+	return _size;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::capacity() const
+{
+	return _capacity;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::memory_usage() const
+{
+	return _impl == nullptr || _is_inline(_impl) ? 0 : _capacity*sizeof(T);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::clear()
+{
+	_destroy_all();
+	_size = 0;
+	_start = 0;
+
+	size_type capacity = _initial_capacity();
+	if (_capacity == capacity) 
+		return;
+
+	T* tmp = _allocate(capacity);
+	_deallocate(_impl, _capacity);
+	_impl = tmp;
+	_capacity = capacity;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reserve(typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type amount)
+{
+	if (amount <= _capacity) 
+		return;
+
+	_resize(amount);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::shrink_to_fit()
+{
+	if (_fit_capacity(_size) < _capacity) 
+		_resize(_size);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::grow_count() const
+{
+	return _grows;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::shrink_count() const
+{
+	return _shrinks;
+}
+
+#ifdef DEQUE_STATS
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DequeStats Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::stats() const
+{
+	DequeStats result = _stats;
+	result.grows = _grows;
+	result.shrinks = _shrinks;
+	return result;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reset_stats()
+{
+	_stats = DequeStats();
+	_stats.peak_size = _size;
+	_stats.peak_capacity = _capacity;
+	_grows = 0;
+	_shrinks = 0;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::set_resize_hook(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::resize_hook_type hook)
+{
+	_resize_hook = std::move(hook);
+}
+#endif
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::operator[](Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::difference_type index)
+{
+	return _get(index);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::operator[](Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::difference_type index) const
+{
+	return _get(index);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::operator=(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other)
+{
+	if (this == &other) 
+		return *this;
+	if (_allocator_traits::propagate_on_container_copy_assignment::value && _alloc != other._alloc)
+	{
+		//our buffer belongs to the old allocator, so it has to go before the switch
+		_release();
+		_assign_allocator(other._alloc, 
+			typename _allocator_traits::propagate_on_container_copy_assignment());
+	}
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity> copy(other, _alloc);
+	_swap_storage(copy);
+	return *this;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::operator=(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&& other) 
+	noexcept(std::allocator_traits<TAllocator>::propagate_on_container_move_assignment::value
+		&& (InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value))
+{
+	if (this == &other) 
+		return *this;
+	if (_allocator_traits::propagate_on_container_move_assignment::value)
+	{
+		_release();
+		_assign_allocator(std::move(other._alloc), 
+			typename _allocator_traits::propagate_on_container_move_assignment());
+		_take_storage(other);
+		return *this;
+	}
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity> tmp(std::move(other), _alloc);
+	_swap_storage(tmp);
+	return *this;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::swap(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other) 
+	noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value)
+{
+	//like the standard containers, swapping deques with unequal non-propagating
+	//allocators is undefined
+	_swap_allocator(other, typename _allocator_traits::propagate_on_container_swap());
+	_swap_storage(other);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void swap(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& first, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& second) 
+	noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value)
+{
+	first.swap(second);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::push_back(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value)
+{
+	emplace_back(value);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::push_back(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::value_type&& value)
+{
+	emplace_back(std::move(value));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename... TArgs>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::emplace_back(TArgs&&... args)
+{
+	if (_size == _capacity)
+	{
+		//args may refer to our own elements, so build the value before they move
+		T tmp(std::forward<TArgs>(args)...);
+		_grow();
+		_allocator_traits::construct(_alloc, _impl + _index(_size), std::move(tmp));
+	}
+	else
+	{
+		_allocator_traits::construct(_alloc, _impl + _index(_size), std::forward<TArgs>(args)...);
+	}
+	++_size;
+	_count(&DequeStats::push_back, 1);
+	return back();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::pop_back()
+{
+	//behaviour on empty containers is undefined, just as it is in STL
+	_allocator_traits::destroy(_alloc, &back());
+	--_size;
+	_count(&DequeStats::pop_back, 1);
+	_normalize();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::push_back_overwrite(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value)
+{
+	emplace_back_overwrite(value);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::push_back_overwrite(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::value_type&& value)
+{
+	emplace_back_overwrite(std::move(value));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename... TArgs>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::emplace_back_overwrite(TArgs&&... args)
+{
+	if (_size < _capacity || _capacity == 0)
+		return emplace_back(std::forward<TArgs>(args)...);
+
+	//the slot after the back of a full ring is the front, so the new element
+	//simply takes its place. args may refer to the front, hence the copy first
+	T tmp(std::forward<TArgs>(args)...);
+	_allocator_traits::destroy(_alloc, _impl + _start);
+	_allocator_traits::construct(_alloc, _impl + _start, std::move(tmp));
+	_start = _index(1);
+	_count(&DequeStats::push_back, 1);
+	_count(&DequeStats::pop_front, 1);
+	return back();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::push_front(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value)
+{
+	emplace_front(value);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::push_front(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::value_type&& value)
+{
+	emplace_front(std::move(value));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename... TArgs>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::emplace_front(TArgs&&... args)
+{
+	if (_size == _capacity)
+	{
+		T tmp(std::forward<TArgs>(args)...);
+		_grow();
+		size_type start = _start == 0 ? _capacity - 1 : _start - 1;
+		_allocator_traits::construct(_alloc, _impl + start, std::move(tmp));
+		_start = start;
+	}
+	else
+	{
+		size_type start = _start == 0 ? _capacity - 1 : _start - 1;
+		_allocator_traits::construct(_alloc, _impl + start, std::forward<TArgs>(args)...);
+		_start = start;
+	}
+	++_size;
+	_count(&DequeStats::push_front, 1);
+	return front();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::pop_front()
+{
+	//behaviour on empty containers is undefined, just as it is in STL
+	_allocator_traits::destroy(_alloc, _impl + _start);
+	_start = _index(1);
+	--_size;
+	_count(&DequeStats::pop_front, 1);
+	_normalize();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TInputIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::append(TInputIt first, TInputIt last)
+{
+	_append(first, last, typename std::iterator_traits<TInputIt>::iterator_category());
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TInputIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::prepend(TInputIt first, TInputIt last)
+{
+	_prepend(first, last, typename std::iterator_traits<TInputIt>::iterator_category());
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::pop_back_n(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count)
+{
+	//popping more than size() elements is undefined, just as pop_back on empty is
+	_destroy_range(_size - count, _size);
+	_size -= count;
+	_count(&DequeStats::pop_back, count);
+	_normalize();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::pop_front_n(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count)
+{
+	_destroy_range(0, count);
+	_start = _index(count);
+	_size -= count;
+	_count(&DequeStats::pop_front, count);
+	_normalize();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::insert(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator position, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value)
+{
+	return emplace(position, value);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::insert(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator position, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::value_type&& value)
+{
+	return emplace(position, std::move(value));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TInputIt>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::insert(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator position, TInputIt first, TInputIt last)
+{
+	return _insert(position - cbegin(), first, last, 
+		typename std::iterator_traits<TInputIt>::iterator_category());
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename... TArgs>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::emplace(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator position, TArgs&&... args)
+{
+	//args may refer to an element that is about to be shifted
+	T tmp(std::forward<TArgs>(args)...);
+	return _insert(position - cbegin(), std::make_move_iterator(&tmp), 
+		std::make_move_iterator(&tmp + 1), std::random_access_iterator_tag());
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::erase(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator position)
+{
+	return erase(position, position + 1);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::erase(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator first, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator last)
+{
+	size_type index = first - cbegin();
+	size_type count = last - first;
+	if (count == 0) 
+		return _make_iterator(index);
+
+	if (index < _size - index - count)
+	{
+		for (size_type i = index; i-- > 0;)
+			_get(i + count) = std::move(_get(i));
+		_destroy_range(0, count);
+		_start = _index(count);
+	}
+	else
+	{
+		for (size_type i = index + count; i < _size; ++i)
+			_get(i - count) = std::move(_get(i));
+		_destroy_range(_size - count, _size);
+	}
+	_size -= count;
+	_normalize();
+	return _make_iterator(index);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TCompare>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::sort(TCompare compare)
+{
+	//one rotation makes every later comparison and swap a plain pointer access
+	pointer data = linearize();
+	std::sort(data, data + _size, compare);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TCompare>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::lower_bound(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value, TCompare compare)
+{
+	return _make_iterator(_bound(value, compare, false));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TCompare>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::lower_bound(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value, TCompare compare) const
+{
+	return _make_iterator(_bound(value, compare, false));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TCompare>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::upper_bound(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value, TCompare compare)
+{
+	return _make_iterator(_bound(value, compare, true));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TCompare>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::upper_bound(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value, TCompare compare) const
+{
+	return _make_iterator(_bound(value, compare, true));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TCompare>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::insert_sorted(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value, TCompare compare)
+{
+	return insert(upper_bound(value, compare), value);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TCompare>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::insert_sorted(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::value_type&& value, TCompare compare)
+{
+	return insert(upper_bound(value, compare), std::move(value));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TInputIt, typename TCompare>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::merge(TInputIt first, TInputIt last, TCompare compare)
+{
+	_merge(first, last, compare, typename std::iterator_traits<TInputIt>::iterator_category());
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TRandomIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::apply(TRandomIt first, TRandomIt last)
+{
+	//the dry run has no branches on the operations, it costs little next to the replay
+	size_type size = _size;
+	size_type peak = _size;
+	bool valid = true;
+	for (TRandomIt op = first; op != last; ++op)
+	{
+		DequeOpType type = op->type;
+		bool push = (type == DequeOpType::PushBack) | (type == DequeOpType::PushFront);
+		bool pop = (type == DequeOpType::PopBack) | (type == DequeOpType::PopFront);
+		valid &= !((pop & (size == 0)) | ((type == DequeOpType::IndexSet) & (op->index >= size)));
+		size = size + push - pop;
+		peak = std::max(peak, size);
+	}
+	if (!valid) 
+		throw std::out_of_range("Deque: batch pops an empty deque or indexes past the end");
+	bool grows = peak > _capacity;
+	_reserve_extra(peak - _size);
+	_replay(first, last, std::is_trivially_copyable<T>());
+
+	//a batch that has just grown the buffer does not shrink it again
+	if (!grows) 
+		_normalize();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TBatch>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::apply(const TBatch& batch)
+{
+	apply(std::begin(batch), std::end(batch));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR std::pair<typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::span_type, typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::span_type> 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::as_spans()
+{
+	size_type head = std::min(_size, _capacity - _start);
+	return std::make_pair(span_type{_impl + _start, head}, span_type{_impl, _size - head});
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR std::pair<typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_span_type, 
+	typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_span_type> Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::as_spans() const
+{
+	size_type head = std::min(_size, _capacity - _start);
+	return std::make_pair(const_span_type{_impl + _start, head}, 
+		const_span_type{_impl, _size - head});
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::pointer Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::linearize()
+{
+	if (_start == 0) 
+		return _impl;
+
+	size_type head = std::min(_size, _capacity - _start);
+	size_type tail = _size - head;
+
+	//slide the run at the end of the buffer down to meet the wrapped part, 
+	//then a rotate puts it in front
+	_shift_down(tail, _start, head, std::is_trivially_copyable<T>());
+	std::rotate(_impl, _impl + tail, _impl + _size);
+	_start = 0;
+	return _impl;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::span_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reserve_back_span(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count)
+{
+	static_assert(std::is_trivially_copyable<T>::value, 
+		"Writing into raw storage requires a trivially copyable type");
+
+	if (_size + count > _capacity) 
+		_reserve_extra(count);
+
+	size_type free = _capacity - _size;
+	size_type begin = _index(_size);
+	if (begin < _start || _start == 0)
+	{
+		//the free part of the ring is contiguous
+		return span_type{_impl + begin, free};
+	}
+	if (_capacity - begin < count) 
+	{
+		linearize();
+		begin = _size;
+	}
+	//a full ring has begin == _start, where the run up to the end of the buffer is all live
+	return span_type{_impl + begin, std::min(free, _capacity - begin)};
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::commit_back(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count)
+{
+	_size += count;
+	_count(&DequeStats::push_back, count);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::back()
+{
+	return operator[](_size - 1);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::back() const
+{
+	return operator[](_size - 1);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::front()
+{
+	return _impl[_start];
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::front() const
+{
+	return _impl[_start];
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::begin()
+{
+	return _make_iterator(0);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::begin() const
+{
+	return _make_iterator(0);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::cbegin() const
+{
+	return _make_iterator(0);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::end()
+{
+	return _make_iterator(_size);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::end() const
+{
+	return _make_iterator(_size);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::cend() const
+{
+	return _make_iterator(_size);
+}
+
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reverse_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::rbegin()
+{
+	return 
+		reverse_iterator(_make_iterator(_size));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reverse_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::rbegin() const
+{
+	return 
+		const_reverse_iterator(_make_iterator(_size));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reverse_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::crbegin() const
+{
+	return 
+		const_reverse_iterator(_make_iterator(_size));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reverse_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::rend()
+{
+	return 
+		reverse_iterator(_make_iterator(0));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reverse_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::rend() const
+{
+	return 
+		const_reverse_iterator(_make_iterator(0));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reverse_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::crend() const
+{
+	return 
+		const_reverse_iterator(_make_iterator(0));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::~Deque()
+{
+	_destroy_all();
+	_deallocate(_impl, _capacity);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_count(size_type DequeStats::* counter, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count)
+{
+#ifdef DEQUE_STATS
+	_stats.*counter += count;
+	_stats.peak_size = std::max(_stats.peak_size, _size);
+	_stats.peak_capacity = std::max(_stats.peak_capacity, _capacity);
+#else
+	(void) counter;
+	(void) count;
+#endif
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_swap_storage(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other) 
+	noexcept(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value)
+{
+	if (!_is_inline(_impl) && !other._is_inline(other._impl))
+	{
+		std::swap(_impl, other._impl);
+		std::swap(_capacity, other._capacity);
+		std::swap(_size, other._size);
+		std::swap(_start, other._start);
+		std::swap(_grows, other._grows);
+		std::swap(_shrinks, other._shrinks);
+#ifdef DEQUE_STATS
+		std::swap(_stats, other._stats);
+#endif
+		return;
+	}
+
+	//inline buffers can not trade places, their elements have to move
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity> tmp(_alloc);
+	tmp._release();
+	tmp._take_storage(other);
+	other._take_storage(*this);
+	_take_storage(tmp);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_take_storage(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other)
+{
+	//expects this deque to hold no elements and no heap buffer
+	_grows = other._grows;
+	_shrinks = other._shrinks;
+#ifdef DEQUE_STATS
+	_stats = other._stats;
+#endif
+	if (!other._is_inline(other._impl))
+	{
+		//moved-from deque is left empty with no buffer, the next push allocates one
+		_impl = other._impl;
+		_capacity = other._capacity;
+		_size = other._size;
+		_start = other._start;
+		other._impl = nullptr;
+		other._capacity = 0;
+		other._size = 0;
+		other._start = 0;
+		return;
+	}
+
+	_impl = this->_inline_data();
+	_capacity = InlineCapacity;
+	_start = 0;
+	try
+	{
+		for (; _size < other._size; ++_size)
+			_allocator_traits::construct(_alloc, _impl + _size, std::move(other[_size]));
+	}
+	catch (...)
+	{
+		_destroy_all();
+		_size = 0;
+		throw;
+	}
+	other._destroy_all();
+	other._size = 0;
+	other._start = 0;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_release()
+{
+	_destroy_all();
+	_deallocate(_impl, _capacity);
+	_impl = nullptr;
+	_capacity = 0;
+	_size = 0;
+	_start = 0;
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TOther>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_assign_allocator(TOther&& alloc, std::true_type)
+{
+	_alloc = std::forward<TOther>(alloc);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TOther>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_assign_allocator(TOther&&, std::false_type)
+{
+
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_swap_allocator(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other, std::true_type) noexcept
+{
+	using std::swap;
+	swap(_alloc, other._alloc);
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_swap_allocator(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&, std::false_type) noexcept
 {
 
 }
 
-template<typename T>
-Deque<T>::Deque(const Deque<T>& other)
-	: _impl(new T[other._capacity]), _capacity(other._capacity), _size(other._size), _start(other._start)
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_grow()
 {
-	std::copy(other._impl, other._impl + other._capacity, _impl);
+	if (_size >= _capacity) 
+		_resize(GROWTH_FACTOR*_capacity);
 }
 
-template<typename T>
-bool Deque<T>::empty() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_reserve_extra(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count)
 {
-	return _size == 0;
+	if (_size + count <= _capacity) 
+		return;
+
+	size_type capacity = GROWTH_FACTOR*_capacity;
+	if (capacity < _size + count) 
+		capacity = _size + count;
+	_resize(capacity);
 }
 
-template<typename T>
-typename Deque<T>::size_type Deque<T>::size() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_destroy_range(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type first, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type last)
 {
-	return _size;
+	if (std::is_trivially_destructible<T>::value)
+		return;
+	for (size_type i = first; i < last; ++i)
+		_allocator_traits::destroy(_alloc, &_get(i));
 }
 
-template<typename T>
-typename Deque<T>::size_type Deque<T>::capacity() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_shift_down(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type dest, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type src, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count, 
+	std::true_type)
 {
-	return _capacity;
+	if (DEQUE_CONSTANT_EVALUATED())
+		_shift_down(dest, src, count, std::false_type());
+	else if (count > 0 && dest != src)
+		std::memmove(_impl + dest, _impl + src, count*sizeof(T));
 }
 
-template<typename T>
-void Deque<T>::clear()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_shift_down(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type dest, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type src, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count, 
+	std::false_type)
 {
-	if (_impl != nullptr) 
-		delete[] _impl;
+	//moves [src, src + count) to [dest, dest + count) with dest < src, 
+	//where [dest, src) is raw memory
+	if (dest == src) 
+		return;
+	for (size_type i = 0; i < count; ++i)
+	{
+		if (dest + i < src)
+			_allocator_traits::construct(_alloc, _impl + dest + i, std::move(_impl[src + i]));
+		else
+			_impl[dest + i] = std::move(_impl[src + i]);
+	}
+	for (size_type i = std::max(src, dest + count); i < src + count; ++i)
+		_allocator_traits::destroy(_alloc, _impl + i);
+}
 
-	_capacity = DEFAULT_SIZE;
-	_impl = new T[_capacity];
-	_size = 0;
-	_start = 0;
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TInputIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_append(TInputIt first, TInputIt last, std::input_iterator_tag)
+{
+	for (; first != last; ++first)
+		emplace_back(*first);
 }
 
-template<typename T>
-void Deque<T>::reserve(typename Deque<T>::size_type amount)
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TForwardIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_append(TForwardIt first, TForwardIt last, 
+	std::forward_iterator_tag)
 {
-	if (amount <= _capacity) 
+	size_type count = std::distance(first, last);
+	if (count == 0) 
 		return;
+	_reserve_extra(count);
 
-	_resize(amount);
+	//the free part of the ring is [_size, _capacity), which wraps at most once
+	size_type begin = _index(_size);
+	size_type head = std::min(count, _capacity - begin);
+	TForwardIt middle = std::next(first, head);
+	_construct_copy(first, middle, _impl + begin);
+	_size += head;
+	_construct_copy(middle, last, _impl + _index(_size));
+	_size += count - head;
+	_count(&DequeStats::push_back, count);
 }
 
-template<typename T>
-typename Deque<T>::reference Deque<T>::operator[](Deque<T>::difference_type index)
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TInputIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_prepend(TInputIt first, TInputIt last, std::input_iterator_tag)
 {
-	return _get(index);
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity> tmp(_alloc);
+	tmp._append(first, last, std::input_iterator_tag());
+	_prepend(std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()), 
+		std::random_access_iterator_tag());
 }
 
-template<typename T>
-typename Deque<T>::const_reference Deque<T>::operator[](Deque<T>::difference_type index) const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TForwardIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_prepend(TForwardIt first, TForwardIt last, 
+	std::forward_iterator_tag)
 {
-	return _get(index);
+	size_type count = std::distance(first, last);
+	if (count == 0) 
+		return;
+	_reserve_extra(count);
+
+	size_type begin = _start >= count ? _start - count : _start + _capacity - count;
+	size_type head = std::min(count, _capacity - begin);
+	TForwardIt middle = std::next(first, head);
+	_construct_copy(first, middle, _impl + begin);
+	try
+	{
+		_construct_copy(middle, last, _impl);
+	}
+	catch (...)
+	{
+		for (size_type i = 0; i < head; ++i)
+			_allocator_traits::destroy(_alloc, _impl + begin + i);
+		throw;
+	}
+	_start = begin;
+	_size += count;
+	_count(&DequeStats::push_front, count);
 }
 
-template<typename T>
-Deque<T>& Deque<T>::operator=(const Deque<T>& other)
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TInputIt>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_insert(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type index, TInputIt first, TInputIt last, 
+	std::input_iterator_tag)
 {
-	if (this == &other) 
-		return *this;
-	_capacity = other._capacity;
-	if (_impl != nullptr) 
-		delete[] _impl;
-	_impl = new T[_capacity];
-	std::copy(other._impl, other._impl + other._capacity, _impl);
-	_size = other._size;
-	_start = other._start;
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity> tmp(_alloc);
+	tmp._append(first, last, std::input_iterator_tag());
+	return _insert(index, std::make_move_iterator(tmp.begin()), 
+		std::make_move_iterator(tmp.end()), std::random_access_iterator_tag());
 }
 
-template<typename T>
-void Deque<T>::push_back(Deque<T>::const_reference value)
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TForwardIt>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_insert(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type index, TForwardIt first, TForwardIt last, 
+	std::forward_iterator_tag)
 {
-	operator[](_size) = value;
-	++_size;
-	_normalize();
+	if (index == _size)
+	{
+		_append(first, last, std::forward_iterator_tag());
+		return _make_iterator(index);
+	}
+	if (index == 0)
+	{
+		_prepend(first, last, std::forward_iterator_tag());
+		return _make_iterator(index);
+	}
+
+	size_type count = std::distance(first, last);
+	if (count == 0) 
+		return _make_iterator(index);
+	_reserve_extra(count);
+
+	size_type live_begin = 0;
+	size_type live_end = 0;
+	_open_gap(index, count, index < _size - index, live_begin, live_end);
+	_fill_gap(index, count, live_begin, live_end, first);
+	return _make_iterator(index);
 }
 
-template<typename T>
-void Deque<T>::pop_back()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_open_gap(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type index, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count, bool front, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type& live_begin, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type& live_end)
 {
-	//behaviour on empty containers is undefined, just as it is in STL
-	--_size;
-	_normalize();
+	//makes [index, index + count) a gap by moving [0, index) towards the front if front is set,
+	//or [index, _size) towards the back otherwise. the slots in [live_begin, live_end) of it 
+	//still hold moved-from objects and the rest is raw memory.
+	//T's move operations are expected not to throw here
+	if (front)
+	{
+		_start = _start >= count ? _start - count : _start + _capacity - count;
+		_move_ring(0, count, index, std::is_trivially_copyable<T>());
+		live_begin = std::max(index, count);
+		live_end = index + count;
+	}
+	else
+	{
+		_move_ring(index + count, index, _size - index, std::is_trivially_copyable<T>());
+		live_begin = index;
+		live_end = std::min(_size, index + count);
+	}
+	_size += count;
 }
 
-template<typename T>
-void Deque<T>::push_front(Deque<T>::const_reference value)
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_move_ring(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type dest, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type src, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count, 
+	std::true_type)
 {
-	if (_start == 0) 
-		_start = _capacity - 1;
-	else 
-		_start--;
+	if (DEQUE_CONSTANT_EVALUATED())
+	{
+		_move_ring(dest, src, count, std::false_type());
+		return;
+	}
+	//one memmove per piece that is contiguous in both places, 
+	//taken in the order that never overwrites what is still to be moved
+	if (dest < src)
+	{
+		for (size_type done = 0; done < count;)
+		{
+			size_type from = _index(src + done);
+			size_type to = _index(dest + done);
+			size_type piece = std::min({count - done, _ring_capacity() - from, _ring_capacity() - to});
+			std::memmove(_impl + to, _impl + from, piece*sizeof(T));
+			done += piece;
+		}
+	}
+	else
+	{
+		for (size_type left = count; left > 0;)
+		{
+			size_type from = _index(src + left - 1) + 1;
+			size_type to = _index(dest + left - 1) + 1;
+			size_type piece = std::min({left, from, to});
+			std::memmove(_impl + to - piece, _impl + from - piece, piece*sizeof(T));
+			left -= piece;
+		}
+	}
+}
 
-	++_size;
-	_impl[_start] = value;
-	_normalize();
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_move_ring(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type dest, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type src, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count, 
+	std::false_type)
+{
+	//moves the positions [src, src + count) to [dest, dest + count), 
+	//the part of the destination outside of the source is raw memory
+	if (dest < src)
+	{
+		for (size_type i = 0; i < count; ++i)
+		{
+			if (dest + i < src)
+				_allocator_traits::construct(_alloc, &_get(dest + i), std::move(_get(src + i)));
+			else
+				_get(dest + i) = std::move(_get(src + i));
+		}
+	}
+	else
+	{
+		for (size_type i = count; i-- > 0;)
+		{
+			if (dest + i >= src + count)
+				_allocator_traits::construct(_alloc, &_get(dest + i), std::move(_get(src + i)));
+			else
+				_get(dest + i) = std::move(_get(src + i));
+		}
+	}
 }
 
-template<typename T>
-void Deque<T>::pop_front()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TForwardIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_fill_gap(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type index, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type live_begin, 
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type live_end, TForwardIt first)
 {
-	//behaviour on empty containers is undefined, just as it is in STL
-	++_start;
-	if (_start >= _capacity) _start = 0;
-	--_size;
-	_normalize();
+	for (size_type i = index; i < index + count; ++i, ++first)
+	{
+		if (live_begin <= i && i < live_end)
+			_get(i) = *first;
+		else
+			_allocator_traits::construct(_alloc, &_get(i), *first);
+	}
 }
 
-template<typename T>
-typename Deque<T>::reference Deque<T>::back()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TValue>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_store(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type index, bool live, TValue&& value)
 {
-	return operator[](_size - 1);
+	if (live)
+		_get(index) = std::forward<TValue>(value);
+	else
+		_allocator_traits::construct(_alloc, &_get(index), std::forward<TValue>(value));
 }
 
-template<typename T>
-typename Deque<T>::const_reference Deque<T>::back() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TRandomIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_replay(TRandomIt first, TRandomIt last, std::true_type)
 {
-	return operator[](_size - 1);
+	if (DEQUE_CONSTANT_EVALUATED())
+	{
+		_replay(first, last, std::false_type());
+		return;
+	}
+
+	//with the capacity settled, every operation is one store and two counter updates
+	//picked by masks instead of branches, which a mix of operations would mispredict.
+	//pops store into a scratch slot
+	const size_type PUSH_BACK = size_type(DequeOpType::PushBack);
+	const size_type PUSH_FRONT = size_type(DequeOpType::PushFront);
+	const size_type POP_BACK = size_type(DequeOpType::PopBack);
+	const size_type POP_FRONT = size_type(DequeOpType::PopFront);
+	const size_type INDEX_SET = size_type(DequeOpType::IndexSet);
+
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type scratch;
+	size_type capacity = _ring_capacity();
+	size_type start = _start;
+	size_type size = _size;
+	size_type counts[5] = {};
+	for (; first != last; ++first)
+	{
+		size_type type = size_type(first->type);
+		bool pop = (type == POP_BACK) | (type == POP_FRONT);
+		size_type position = (size & (0 - size_type(type == PUSH_BACK)))
+			| ((capacity - 1) & (0 - size_type(type == PUSH_FRONT)))
+			| (first->index & (0 - size_type(type == INDEX_SET)));
+		position += start;
+		position -= capacity & (0 - size_type(position >= capacity));
+
+		void* targets[2] = {_impl + position, &scratch};
+		T value(first->value);
+		std::memcpy(targets[pop], &value, sizeof(T));
+
+		start += size_type(type == POP_FRONT) + ((capacity - 1) & (0 - size_type(type == PUSH_FRONT)));
+		start -= capacity & (0 - size_type(start >= capacity));
+		size += size_type((type == PUSH_BACK) | (type == PUSH_FRONT)) - size_type(pop);
+		++counts[type];
+	}
+	_start = start;
+	_size = size;
+	_count(&DequeStats::push_back, counts[PUSH_BACK]);
+	_count(&DequeStats::push_front, counts[PUSH_FRONT]);
+	_count(&DequeStats::pop_back, counts[POP_BACK]);
+	_count(&DequeStats::pop_front, counts[POP_FRONT]);
 }
 
-template<typename T>
-typename Deque<T>::reference Deque<T>::front()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TRandomIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_replay(TRandomIt first, TRandomIt last, std::false_type)
 {
-	return _impl[_start];
+	//elements with real constructors go by runs, so cancelled pushes are never built
+	while (first != last)
+	{
+		switch (first->type)
+		{
+			case DequeOpType::PushBack:
+			case DequeOpType::PopBack:
+				first = _apply_back(first, last);
+				break;
+
+			case DequeOpType::PushFront:
+			case DequeOpType::PopFront:
+				first = _apply_front(first, last);
+				break;
+
+			case DequeOpType::IndexSet:
+				_get(first->index) = first->value;
+				++first;
+				break;
+		}
+	}
 }
 
-template<typename T>
-typename Deque<T>::const_reference Deque<T>::front() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TRandomIt>
+DEQUE_CONSTEXPR TRandomIt Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_apply_back(TRandomIt first, TRandomIt last)
 {
-	return _impl[_start];
+	//takes a run of pushes and the run of pops right after it, 
+	//the last pushes cancel against the first pops and are never written
+	TRandomIt pushed = first;
+	while (pushed != last && pushed->type == DequeOpType::PushBack)
+		++pushed;
+	TRandomIt popped = pushed;
+	while (popped != last && popped->type == DequeOpType::PopBack)
+		++popped;
+	size_type cancelled = std::min(pushed - first, popped - pushed);
+	size_type pushes = (pushed - first) - cancelled;
+	size_type pops = (popped - pushed) - cancelled;
+
+	//the free slots after the back are at most two contiguous pieces
+	for (size_type left = pushes; left > 0;)
+	{
+		pointer slot = _impl + _index(_size);
+		size_type piece = std::min(left, size_type(_impl + _ring_capacity() - slot));
+		for (size_type i = 0; i < piece; ++i, ++first)
+		{
+			_allocator_traits::construct(_alloc, slot + i, first->value);
+			++_size;
+		}
+		left -= piece;
+	}
+	_destroy_range(_size - pops, _size);
+	_size -= pops;
+
+	_count(&DequeStats::push_back, pushes + cancelled);
+	_count(&DequeStats::pop_back, pops + cancelled);
+	return popped;
 }
 
-template<typename T>
-typename Deque<T>::iterator Deque<T>::begin()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TRandomIt>
+DEQUE_CONSTEXPR TRandomIt Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_apply_front(TRandomIt first, TRandomIt last)
 {
-	return Deque<T>::iterator(this, 0);
+	TRandomIt pushed = first;
+	while (pushed != last && pushed->type == DequeOpType::PushFront)
+		++pushed;
+	TRandomIt popped = pushed;
+	while (popped != last && popped->type == DequeOpType::PopFront)
+		++popped;
+	size_type cancelled = std::min(pushed - first, popped - pushed);
+	size_type pushes = (pushed - first) - cancelled;
+	size_type pops = (popped - pushed) - cancelled;
+
+	//the free slots before the front are filled downwards, 
+	//wrapping to the end of the buffer at most once
+	for (size_type left = pushes; left > 0;)
+	{
+		size_type end = _start == 0 ? _ring_capacity() : _start;
+		size_type piece = std::min(left, end);
+		for (size_type i = 1; i <= piece; ++i, ++first)
+		{
+			_allocator_traits::construct(_alloc, _impl + end - i, first->value);
+			_start = end - i;
+			++_size;
+		}
+		left -= piece;
+	}
+	_destroy_range(0, pops);
+	_start = _index(pops);
+	_size -= pops;
+
+	_count(&DequeStats::push_front, pushes + cancelled);
+	_count(&DequeStats::pop_front, pops + cancelled);
+	return popped;
 }
 
-template<typename T>
-typename Deque<T>::const_iterator Deque<T>::begin() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TCompare>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_bound(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_reference value, TCompare compare, bool upper) const
 {
-	return Deque<T>::const_iterator(this, 0);
+	//the last element of the first run tells which run holds the answer
+	std::pair<const_span_type, const_span_type> spans = as_spans();
+	const_span_type run = spans.first;
+	size_type skipped = 0;
+	if (spans.second.size > 0)
+	{
+		const_reference last = spans.first.data[spans.first.size - 1];
+		if (upper ? !compare(value, last) : compare(last, value))
+		{
+			run = spans.second;
+			skipped = spans.first.size;
+		}
+	}
+	const_pointer found = upper 
+		? std::upper_bound(run.data, run.data + run.size, value, compare)
+		: std::lower_bound(run.data, run.data + run.size, value, compare);
+	return skipped + (found - run.data);
 }
 
-template<typename T>
-typename Deque<T>::const_iterator Deque<T>::cbegin() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TInputIt, typename TCompare>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_merge(TInputIt first, TInputIt last, TCompare compare, 
+	std::input_iterator_tag)
 {
-	return Deque<T>::const_iterator(this, 0);
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity> tmp(_alloc);
+	tmp._append(first, last, std::input_iterator_tag());
+	_merge(std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()), compare, 
+		std::random_access_iterator_tag());
 }
 
-template<typename T>
-typename Deque<T>::iterator Deque<T>::end()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TRandomIt, typename TCompare>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_merge(TRandomIt first, TRandomIt last, TCompare compare, 
+	std::random_access_iterator_tag)
 {
-	return Deque<T>::iterator(this, _size);
+	size_type count = last - first;
+	if (count == 0) 
+		return;
+	_reserve_extra(count);
+
+	//only the elements in [begin, end) interleave with the new ones, 
+	//whichever side lies outside of that range is shorter gets moved to make room
+	size_type begin = _bound(*first, compare, true);
+	size_type end = _bound(*(last - 1), compare, true);
+	size_type live_begin = 0;
+	size_type live_end = 0;
+	if (begin < _size - end)
+	{
+		//the gap is in front of the overlap, fill it front to back
+		_open_gap(begin, count, true, live_begin, live_end);
+		size_type gap_end = begin + count;
+		size_type source = gap_end;
+		for (size_type i = begin; first != last; ++i)
+		{
+			bool live = i >= gap_end || (live_begin <= i && i < live_end);
+			if (source < end + count && !compare(*first, _get(source)))
+				_store(i, live, std::move(_get(source++)));
+			else
+				_store(i, live, *first++);
+		}
+	}
+	else
+	{
+		//the gap is behind the overlap, fill it back to front
+		_open_gap(end, count, false, live_begin, live_end);
+		size_type source = end;
+		for (size_type i = end + count; first != last;)
+		{
+			--i;
+			bool live = i < end || (live_begin <= i && i < live_end);
+			if (source > begin && compare(*(last - 1), _get(source - 1)))
+				_store(i, live, std::move(_get(--source)));
+			else
+				_store(i, live, *--last);
+		}
+	}
 }
 
-template<typename T>
-typename Deque<T>::const_iterator Deque<T>::end() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_normalize()
 {
-	return Deque<T>::const_iterator(this, _size);
+	//the gap between SHRINK_THRESHOLD and GROWTH_FACTOR is what keeps 
+	//a deque oscillating around one size from reallocating back and forth
+	if (SHRINK_THRESHOLD == 0 || SHRINK_THRESHOLD*_size > _capacity) 
+		return;
+
+	size_type capacity = _fit_capacity(GROWTH_FACTOR*_size);
+	if (capacity < _capacity) 
+		_resize(capacity);
 }
 
-template<typename T>
-typename Deque<T>::const_iterator Deque<T>::cend() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_resize(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type capacity)
 {
-	return Deque<T>::const_iterator(this, _size);
+	//a fixed ring may only be allocated, never grown
+	if (TGrowthPolicy::FIXED && capacity > MIN_CAPACITY) 
+		throw std::length_error("Deque: fixed capacity exceeded");
+	capacity = _fit_capacity(capacity);
+#ifdef DEQUE_STATS
+	if (_resize_hook) 
+		_resize_hook(DequeResizeEvent{_size, _capacity, capacity, false});
+#endif
+	
+	//if capacity < _size, behaviour is undefined
+	T* tmp = _allocate(capacity);
+	size_type head = std::min(_size, _capacity - _start);
+	size_type built = 0;
+	try
+	{
+		_relocate(tmp, _impl + _start, head, std::is_trivially_copyable<T>());
+		built = head;
+		_relocate(tmp + head, _impl, _size - head, std::is_trivially_copyable<T>());
+	}
+	catch (...)
+	{
+		//the ring still owns every element, only the copies of the first run go
+		for (size_type i = 0; i < built; ++i)
+			_allocator_traits::destroy(_alloc, tmp + i);
+		_deallocate(tmp, capacity);
+		throw;
+	}
+
+	//the sources are only given up once both runs have been built
+	_destroy_all();
+	std::swap(tmp, _impl);
+
+	_deallocate(tmp, _capacity);
+	if (capacity > _capacity) 
+		++_grows;
+	else
+		++_shrinks;
+#ifdef DEQUE_STATS
+	_stats.bytes_copied += _size*sizeof(T);
+	_stats.peak_capacity = std::max(_stats.peak_capacity, capacity);
+	if (_resize_hook) 
+		_resize_hook(DequeResizeEvent{_size, _capacity, capacity, true});
+#endif
+	_capacity = capacity;
+	_start = 0;
 }
 
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_index(difference_type index) const
+{
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type tmp = _start + index;
+	if (TGrowthPolicy::POWER_OF_TWO) 
+		return tmp & (_ring_capacity() - 1);
+	if (tmp >= _ring_capacity()) 
+		tmp -= _ring_capacity();
+	return tmp;
+}
 
-template<typename T>
-typename Deque<T>::reverse_iterator Deque<T>::rbegin()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::reference Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_get(difference_type index) const
 {
-	return 
-		std::reverse_iterator<Deque<T>::iterator>(Deque<T>::iterator(this, _size));
+	return _impl[_index(index)];
 }
 
-template<typename T>
-typename Deque<T>::const_reverse_iterator Deque<T>::rbegin() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_make_iterator(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type index)
 {
-	return 
-		std::reverse_iterator<Deque<T>::const_iterator>(Deque<T>::const_iterator(this, _size));
+	return iterator(_impl, _capacity, _capacity == 0 ? 0 : _index(index), index);
 }
 
-template<typename T>
-typename Deque<T>::const_reverse_iterator Deque<T>::crbegin() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::const_iterator Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_make_iterator(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type index) const
 {
-	return 
-		std::reverse_iterator<Deque<T>::const_iterator>(Deque<T>::const_iterator(this, _size));
+	return const_iterator(_impl, _capacity, _capacity == 0 ? 0 : _index(index), index);
 }
 
-template<typename T>
-typename Deque<T>::reverse_iterator Deque<T>::rend()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_fit_capacity(
+	Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type capacity)
 {
-	return 
-		std::reverse_iterator<Deque<T>::iterator>(Deque<T>::iterator(this, 0));
+	//anything that fits inline takes the whole inline buffer
+	if (InlineCapacity > 0 && capacity <= InlineCapacity) 
+		return InlineCapacity;
+	if (capacity < MIN_CAPACITY) 
+		capacity = MIN_CAPACITY;
+	if (!TGrowthPolicy::POWER_OF_TWO) 
+		return capacity;
+
+	size_type result = 1;
+	while (result < capacity) 
+		result <<= 1;
+	return result;
 }
 
-template<typename T>
-typename Deque<T>::const_reverse_iterator Deque<T>::rend() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_ring_capacity() const
 {
-	return 
-		std::reverse_iterator<Deque<T>::const_iterator>(Deque<T>::const_iterator(this, 0));
+	return TGrowthPolicy::FIXED ? MIN_CAPACITY : _capacity;
 }
 
-template<typename T>
-typename Deque<T>::const_reverse_iterator Deque<T>::crend() const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR typename Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_initial_capacity()
 {
-	return 
-		std::reverse_iterator<Deque<T>::const_iterator>(Deque<T>::const_iterator(this, 0));
+	return InlineCapacity > 0 ? InlineCapacity : _fit_capacity(MIN_CAPACITY);
 }
 
-template<typename T>
-Deque<T>::~Deque()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR T* Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_allocate(Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type capacity)
 {
-	delete[] _impl;
+	if (capacity == 0) 
+		return nullptr;
+	//the inline buffer may still be in use when relocating within the same capacity
+	if (capacity <= InlineCapacity && _impl != this->_inline_data()) 
+		return this->_inline_data();
+	return _allocator_traits::allocate(_alloc, capacity);
 }
 
-template<typename T>
-void Deque<T>::_normalize()
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_deallocate(T* buffer, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type capacity)
 {
-	//poential place for optimizations and bugs
-	if (_size >= _capacity) 
-		_resize(RESIZE_COEFF*_capacity);
-	else if (RESIZE_COEFF*RESIZE_COEFF*_size <= _capacity) 
-		_resize(RESIZE_COEFF*_size);
+	if (buffer != nullptr && !_is_inline(buffer)) 
+		_allocator_traits::deallocate(_alloc, buffer, capacity);
 }
 
-template<typename T>
-void Deque<T>::_resize(Deque<T>::size_type capacity)
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR bool Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_is_inline(const T* buffer) const
 {
-	if (capacity < DEFAULT_SIZE) 
-		capacity = DEFAULT_SIZE;
-	
-	//if capacity < _size, behaviour is undefined
-	T* tmp = new T[capacity];
-	if (_size <= _capacity - _start)
+	return InlineCapacity > 0 && buffer == this->_inline_data();
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_destroy_all()
+{
+	if (std::is_trivially_destructible<T>::value)
+		return;
+	for (size_type i = 0; i < _size; ++i)
+		_allocator_traits::destroy(_alloc, &_get(i));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_relocate(T* dest, T* src, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count, std::true_type)
+{
+	if (DEQUE_CONSTANT_EVALUATED())
+		_relocate(dest, src, count, std::false_type());
+	else if (count > 0)
+		std::memcpy(dest, src, count*sizeof(T));
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_relocate(T* dest, T* src, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::size_type count, std::false_type)
+{
+	//moves into the raw buffer, or copies when the move may throw and a copy is possible.
+	//the sources are left alive, on a throw nothing built here survives
+	size_type moved = 0;
+	try
 	{
-		std::copy(_impl + _start, _impl + _start + _size, tmp);
-		//std::memcpy(tmp, _impl + _start, _size*sizeof(T));
+		for (; moved < count; ++moved)
+			_allocator_traits::construct(_alloc, dest + moved, std::move_if_noexcept(src[moved]));
 	}
-	else
+	catch (...)
 	{
-		std::copy(_impl + _start, _impl + _capacity, tmp);
-		//std::memcpy(tmp, _impl + _start, (_capacity - _start)*sizeof(T));
+		for (size_type i = 0; i < moved; ++i)
+			_allocator_traits::destroy(_alloc, dest + i);
+		throw;
+	}
+}
 
-		std::copy(_impl, _impl + _size, tmp + _capacity - _start);
-		//std::memcpy(tmp + _capacity - _start, _impl, (_size - (_capacity - _start))*sizeof(T));
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_copy_elements(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other, std::true_type)
+{
+	if (DEQUE_CONSTANT_EVALUATED())
+	{
+		_copy_elements(other, std::false_type());
+		return;
 	}
 
-	std::swap(tmp, _impl);
+	//both runs of the ring are copied as they are, lined up from the start of the buffer
+	std::pair<const_span_type, const_span_type> spans = other.as_spans();
+	if (spans.first.size > 0)
+		std::memcpy(_impl, spans.first.data, spans.first.size*sizeof(T));
+	if (spans.second.size > 0)
+		std::memcpy(_impl + spans.first.size, spans.second.data, spans.second.size*sizeof(T));
+	_size = other._size;
+}
 
-	_capacity = capacity;
-	_start = 0;
-	delete[] tmp;
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_copy_elements(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& other, std::false_type)
+{
+	try
+	{
+		for (; _size < other._size; ++_size)
+			_allocator_traits::construct(_alloc, _impl + _size, other[_size]);
+	}
+	catch (...)
+	{
+		_destroy_all();
+		_deallocate(_impl, _capacity);
+		throw;
+	}
 }
 
-template<typename T>
-typename Deque<T>::reference Deque<T>::_get(difference_type index) const
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+template<typename TForwardIt>
+DEQUE_CONSTEXPR void Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>::_construct_copy(TForwardIt first, TForwardIt last, T* dest)
 {
-	Deque<T>::size_type tmp = _start + index;
-	if (tmp >= _capacity) 
-		tmp -= _capacity;
-	return _impl[tmp];
+	//std::uninitialized_copy can not run in a constant expression
+	if (!DEQUE_CONSTANT_EVALUATED())
+	{
+		std::uninitialized_copy(first, last, dest);
+		return;
+	}
+
+	T* current = dest;
+	try
+	{
+		for (; first != last; ++first, ++current)
+			_allocator_traits::construct(_alloc, current, *first);
+	}
+	catch (...)
+	{
+		for (; dest != current; ++dest)
+			_allocator_traits::destroy(_alloc, dest);
+		throw;
+	}
 }
 
 // ==================== ITERATORS =======================
@@ -284,6 +1624,14 @@ _iterator_base<TContainerPtr>::_iterator_base(TContainerPtr ptr, difference_type
 
 }
 
+template<typename TContainerPtr>
+template<typename TOtherPtr, typename>
+_iterator_base<TContainerPtr>::_iterator_base(const _iterator_base<TOtherPtr>& other)
+	: _position(other._position), _container(other._container)
+{
+
+}
+
 template<typename TContainerPtr>
 _iterator_base<TContainerPtr>& _iterator_base<TContainerPtr>::operator++()
 {
@@ -400,3 +1748,176 @@ typename std::iterator_traits<_iterator_base<TContainerPtr>>::pointer
 {
 	return &(_container->operator[](_position));
 }
+
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue>::_ring_iterator()
+	: _current(nullptr), _buffer(nullptr), _buffer_end(nullptr), _position(0)
+{
+
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue>::_ring_iterator(pointer buffer, std::size_t capacity, std::size_t offset, 
+	difference_type position)
+	: _current(buffer + offset), _buffer(buffer), _buffer_end(buffer + capacity), 
+	_position(position)
+{
+
+}
+
+template<typename TValue>
+template<typename TOther, typename>
+DEQUE_CONSTEXPR _ring_iterator<TValue>::_ring_iterator(const _ring_iterator<TOther>& other)
+	: _current(other._current), _buffer(other._buffer), _buffer_end(other._buffer_end), 
+	_position(other._position)
+{
+
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue>& _ring_iterator<TValue>::operator++()
+{
+	++_position;
+	if (++_current == _buffer_end) 
+		_current = _buffer;
+	return *this;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue> _ring_iterator<TValue>::operator++(int)
+{
+	own_type copy = *this;
+	operator++();
+	return copy;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue>& _ring_iterator<TValue>::operator--()
+{
+	--_position;
+	if (_current == _buffer) 
+		_current = _buffer_end;
+	--_current;
+	return *this;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue> _ring_iterator<TValue>::operator--(int)
+{
+	own_type copy = *this;
+	operator--();
+	return copy;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue>& _ring_iterator<TValue>::operator+=(difference_type dist)
+{
+	//iterators never get further than a capacity apart, so one wrap is enough
+	difference_type offset = (_current - _buffer) + dist;
+	difference_type capacity = _buffer_end - _buffer;
+	if (offset >= capacity) 
+		offset -= capacity;
+	else if (offset < 0) 
+		offset += capacity;
+	_current = _buffer + offset;
+	_position += dist;
+	return *this;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue>& _ring_iterator<TValue>::operator-=(difference_type dist)
+{
+	return operator+=(-dist);
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue> _ring_iterator<TValue>::operator+(difference_type dist) const
+{
+	own_type copy = *this;
+	copy += dist;
+	return copy;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue> _ring_iterator<TValue>::operator-(difference_type dist) const
+{
+	own_type copy = *this;
+	copy -= dist;
+	return copy;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR typename _ring_iterator<TValue>::difference_type _ring_iterator<TValue>::operator-(
+	const own_type& other) const
+{
+	return _position - other._position;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR _ring_iterator<TValue> operator+(
+	typename _ring_iterator<TValue>::difference_type dist, const _ring_iterator<TValue>& iter)
+{
+	return iter + dist;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR bool _ring_iterator<TValue>::operator==(const own_type& other) const
+{
+	return _position == other._position;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR bool _ring_iterator<TValue>::operator!=(const own_type& other) const
+{
+	return _position != other._position;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR bool _ring_iterator<TValue>::operator<(const own_type& other) const
+{
+	return _position < other._position;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR bool _ring_iterator<TValue>::operator>(const own_type& other) const
+{
+	return _position > other._position;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR bool _ring_iterator<TValue>::operator<=(const own_type& other) const
+{
+	return _position <= other._position;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR bool _ring_iterator<TValue>::operator>=(const own_type& other) const
+{
+	return _position >= other._position;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR typename _ring_iterator<TValue>::reference _ring_iterator<TValue>::operator*() const
+{
+	return *_current;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR typename _ring_iterator<TValue>::pointer _ring_iterator<TValue>::operator->() const
+{
+	return _current;
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR typename _ring_iterator<TValue>::reference _ring_iterator<TValue>::operator[](
+	difference_type dist) const
+{
+	return *(*this + dist);
+}
+
+template<typename TValue>
+DEQUE_CONSTEXPR typename _ring_iterator<TValue>::difference_type _ring_iterator<TValue>::segment_size() const
+{
+	return _buffer_end - _current;
+}
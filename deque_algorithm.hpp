@@ -0,0 +1,30 @@
+#ifndef DEQUE_ALGORITHM_HPP
+#define DEQUE_ALGORITHM_HPP
+
+#include <algorithm>
+#include "deque.hpp"
+
+
+//algorithms over a range of a Deque that run a plain pointer loop over each
+//contiguous run of the ring, so the compiler can unroll and vectorize them
+
+//calls function(pointer, count) once for each contiguous run of [first, last)
+template<typename TValue, typename TFunction>
+TFunction for_each_segment(_ring_iterator<TValue>, _ring_iterator<TValue>, TFunction);
+
+template<typename TValue, typename TOutputIt>
+TOutputIt segmented_copy(_ring_iterator<TValue>, _ring_iterator<TValue>, TOutputIt);
+
+template<typename TValue, typename TOther>
+void segmented_fill(_ring_iterator<TValue>, _ring_iterator<TValue>, const TOther&);
+
+template<typename TValue, typename TOther>
+_ring_iterator<TValue> segmented_find(_ring_iterator<TValue>, _ring_iterator<TValue>, 
+	const TOther&);
+
+template<typename TValue, typename TResult>
+TResult segmented_accumulate(_ring_iterator<TValue>, _ring_iterator<TValue>, TResult);
+
+#include "deque_algorithm.tpp"
+
+#endif //DEQUE_ALGORITHM_HPP
@@ -0,0 +1,65 @@
+#include "deque_algorithm.hpp"
+
+template<typename TValue, typename TFunction>
+TFunction for_each_segment(_ring_iterator<TValue> first, _ring_iterator<TValue> last, 
+	TFunction function)
+{
+	while (first != last)
+	{
+		typename _ring_iterator<TValue>::difference_type count = 
+			std::min(last - first, first.segment_size());
+		function(first.operator->(), count);
+		first += count;
+	}
+	return function;
+}
+
+template<typename TValue, typename TOutputIt>
+TOutputIt segmented_copy(_ring_iterator<TValue> first, _ring_iterator<TValue> last, 
+	TOutputIt out)
+{
+	for_each_segment(first, last, [&out](TValue* data, std::ptrdiff_t count)
+	{
+		out = std::copy(data, data + count, out);
+	});
+	return out;
+}
+
+template<typename TValue, typename TOther>
+void segmented_fill(_ring_iterator<TValue> first, _ring_iterator<TValue> last, 
+	const TOther& value)
+{
+	for_each_segment(first, last, [&value](TValue* data, std::ptrdiff_t count)
+	{
+		std::fill(data, data + count, value);
+	});
+}
+
+template<typename TValue, typename TOther>
+_ring_iterator<TValue> segmented_find(_ring_iterator<TValue> first, _ring_iterator<TValue> last, 
+	const TOther& value)
+{
+	while (first != last)
+	{
+		typename _ring_iterator<TValue>::difference_type count = 
+			std::min(last - first, first.segment_size());
+		TValue* data = first.operator->();
+		TValue* found = std::find(data, data + count, value);
+		if (found != data + count) 
+			return first + (found - data);
+		first += count;
+	}
+	return last;
+}
+
+template<typename TValue, typename TResult>
+TResult segmented_accumulate(_ring_iterator<TValue> first, _ring_iterator<TValue> last, 
+	TResult init)
+{
+	for_each_segment(first, last, [&init](TValue* data, std::ptrdiff_t count)
+	{
+		for (std::ptrdiff_t i = 0; i < count; ++i)
+			init = init + data[i];
+	});
+	return init;
+}
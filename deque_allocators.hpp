@@ -0,0 +1,150 @@
+#ifndef DEQUE_ALLOCATORS_HPP
+#define DEQUE_ALLOCATORS_HPP
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <type_traits>
+
+
+//bump allocator over a list of chunks: allocation is a pointer increment,
+//deallocation is a no-op and everything is returned at once by release()
+//or the destructor. not thread-safe.
+class MonotonicArena
+{
+public:
+	using size_type = std::size_t;
+
+	explicit MonotonicArena(size_type chunk_size = 64*1024);
+	MonotonicArena(const MonotonicArena&) = delete;
+	MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+	void* allocate(size_type bytes, size_type alignment);
+	void release();
+
+	//bytes handed out since the last release
+	size_type allocated() const;
+
+	~MonotonicArena();
+
+private:
+	struct _Chunk
+	{
+		_Chunk* previous;
+		size_type size;
+	};
+
+	void _add_chunk(size_type);
+
+	_Chunk* _chunk;
+	char* _current;
+	char* _end;
+	size_type _chunk_size;
+	size_type _allocated;
+};
+
+//recycles freed buffers in power-of-two size classes, so that a deque
+//resizing back and forth or a stream of short-lived deques reuses
+//the same few blocks instead of going to malloc. not thread-safe.
+class BufferPool
+{
+public:
+	using size_type = std::size_t;
+
+	explicit BufferPool(size_type max_cached = 64);
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+
+	void* allocate(size_type bytes);
+	void deallocate(void*, size_type bytes);
+	void release();
+
+	//buffers currently sitting in the free lists
+	size_type cached() const;
+
+	~BufferPool();
+
+private:
+	struct _Node
+	{
+		_Node* next;
+	};
+
+	static size_type _size_class(size_type);
+
+	//classes cover 16 bytes to 1 MiB, larger buffers go straight to operator new
+	static const size_type MIN_CLASS = 4;
+	static const size_type MAX_CLASS = 20;
+	static const size_type CLASS_COUNT = MAX_CLASS - MIN_CLASS + 1;
+
+	_Node* _free[CLASS_COUNT];
+	size_type _counts[CLASS_COUNT];
+	size_type _max_cached;
+};
+
+//allocator handle over a MonotonicArena. it follows the container on move and swap
+//but not on copy, so a copied deque lands in its owner's memory, not the source's
+template<typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	explicit ArenaAllocator(MonotonicArena&) noexcept;
+	template<typename TOther>
+	ArenaAllocator(const ArenaAllocator<TOther>&) noexcept;
+
+	T* allocate(std::size_t);
+	void deallocate(T*, std::size_t) noexcept;
+
+	MonotonicArena* arena() const noexcept;
+
+private:
+	MonotonicArena* _arena;
+
+	static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+};
+
+template<typename T, typename TOther>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<TOther>&) noexcept;
+template<typename T, typename TOther>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<TOther>&) noexcept;
+
+//allocator handle over a BufferPool, with the same propagation rules as ArenaAllocator
+template<typename T>
+class PoolAllocator
+{
+public:
+	using value_type = T;
+
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	explicit PoolAllocator(BufferPool&) noexcept;
+	template<typename TOther>
+	PoolAllocator(const PoolAllocator<TOther>&) noexcept;
+
+	T* allocate(std::size_t);
+	void deallocate(T*, std::size_t) noexcept;
+
+	BufferPool* pool() const noexcept;
+
+private:
+	BufferPool* _pool;
+
+	static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+};
+
+template<typename T, typename TOther>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<TOther>&) noexcept;
+template<typename T, typename TOther>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<TOther>&) noexcept;
+
+#include "deque_allocators.tpp"
+
+#endif //DEQUE_ALLOCATORS_HPP
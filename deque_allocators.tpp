@@ -0,0 +1,228 @@
+#include "deque_allocators.hpp"
+
+inline MonotonicArena::MonotonicArena(MonotonicArena::size_type chunk_size)
+	: _chunk(nullptr), _current(nullptr), _end(nullptr), _chunk_size(chunk_size), _allocated(0)
+{
+
+}
+
+inline void* MonotonicArena::allocate(MonotonicArena::size_type bytes, MonotonicArena::size_type alignment)
+{
+	std::size_t space = _end - _current;
+	void* result = _current;
+	if (_current == nullptr || std::align(alignment, bytes, result, space) == nullptr)
+	{
+		_add_chunk(bytes + alignment);
+		space = _end - _current;
+		result = _current;
+		std::align(alignment, bytes, result, space);
+	}
+	_current = static_cast<char*>(result) + bytes;
+	_allocated += bytes;
+	return result;
+}
+
+inline void MonotonicArena::release()
+{
+	while (_chunk != nullptr)
+	{
+		_Chunk* previous = _chunk->previous;
+		::operator delete(_chunk);
+		_chunk = previous;
+	}
+	_current = nullptr;
+	_end = nullptr;
+	_allocated = 0;
+}
+
+inline MonotonicArena::size_type MonotonicArena::allocated() const
+{
+	return _allocated;
+}
+
+inline MonotonicArena::~MonotonicArena()
+{
+	release();
+}
+
+inline void MonotonicArena::_add_chunk(MonotonicArena::size_type bytes)
+{
+	//the header is padded to max_align_t, so that the payload starts suitably aligned
+	const size_type header = (sizeof(_Chunk) + alignof(std::max_align_t) - 1)
+		& ~(alignof(std::max_align_t) - 1);
+	size_type size = bytes + header > _chunk_size ? bytes + header : _chunk_size;
+
+	_Chunk* chunk = static_cast<_Chunk*>(::operator new(size));
+	chunk->previous = _chunk;
+	chunk->size = size;
+	_chunk = chunk;
+	_current = reinterpret_cast<char*>(chunk) + header;
+	_end = reinterpret_cast<char*>(chunk) + size;
+}
+
+inline BufferPool::BufferPool(BufferPool::size_type max_cached)
+	: _max_cached(max_cached)
+{
+	for (size_type i = 0; i < CLASS_COUNT; ++i)
+	{
+		_free[i] = nullptr;
+		_counts[i] = 0;
+	}
+}
+
+inline void* BufferPool::allocate(BufferPool::size_type bytes)
+{
+	size_type size_class = _size_class(bytes);
+	if (size_class > MAX_CLASS)
+		return ::operator new(bytes);
+
+	size_type index = size_class - MIN_CLASS;
+	if (_free[index] == nullptr)
+		return ::operator new(size_type(1) << size_class);
+
+	_Node* node = _free[index];
+	_free[index] = node->next;
+	--_counts[index];
+	return node;
+}
+
+inline void BufferPool::deallocate(void* buffer, BufferPool::size_type bytes)
+{
+	size_type size_class = _size_class(bytes);
+	size_type index = size_class - MIN_CLASS;
+	if (size_class > MAX_CLASS || _counts[index] >= _max_cached)
+	{
+		::operator delete(buffer);
+		return;
+	}
+
+	_Node* node = static_cast<_Node*>(buffer);
+	node->next = _free[index];
+	_free[index] = node;
+	++_counts[index];
+}
+
+inline void BufferPool::release()
+{
+	for (size_type i = 0; i < CLASS_COUNT; ++i)
+	{
+		while (_free[i] != nullptr)
+		{
+			_Node* next = _free[i]->next;
+			::operator delete(_free[i]);
+			_free[i] = next;
+		}
+		_counts[i] = 0;
+	}
+}
+
+inline BufferPool::size_type BufferPool::cached() const
+{
+	size_type result = 0;
+	for (size_type i = 0; i < CLASS_COUNT; ++i)
+		result += _counts[i];
+	return result;
+}
+
+inline BufferPool::~BufferPool()
+{
+	release();
+}
+
+inline BufferPool::size_type BufferPool::_size_class(BufferPool::size_type bytes)
+{
+	size_type result = MIN_CLASS;
+	while ((size_type(1) << result) < bytes && result <= MAX_CLASS)
+		++result;
+	return result;
+}
+
+template<typename T>
+ArenaAllocator<T>::ArenaAllocator(MonotonicArena& arena) noexcept
+	: _arena(&arena)
+{
+
+}
+
+template<typename T>
+template<typename TOther>
+ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<TOther>& other) noexcept
+	: _arena(other.arena())
+{
+
+}
+
+template<typename T>
+T* ArenaAllocator<T>::allocate(std::size_t count)
+{
+	return static_cast<T*>(_arena->allocate(count*sizeof(T), alignof(T)));
+}
+
+template<typename T>
+void ArenaAllocator<T>::deallocate(T*, std::size_t) noexcept
+{
+	//memory comes back only when the whole arena is released
+}
+
+template<typename T>
+MonotonicArena* ArenaAllocator<T>::arena() const noexcept
+{
+	return _arena;
+}
+
+template<typename T, typename TOther>
+bool operator==(const ArenaAllocator<T>& first, const ArenaAllocator<TOther>& second) noexcept
+{
+	return first.arena() == second.arena();
+}
+
+template<typename T, typename TOther>
+bool operator!=(const ArenaAllocator<T>& first, const ArenaAllocator<TOther>& second) noexcept
+{
+	return !(first == second);
+}
+
+template<typename T>
+PoolAllocator<T>::PoolAllocator(BufferPool& pool) noexcept
+	: _pool(&pool)
+{
+
+}
+
+template<typename T>
+template<typename TOther>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<TOther>& other) noexcept
+	: _pool(other.pool())
+{
+
+}
+
+template<typename T>
+T* PoolAllocator<T>::allocate(std::size_t count)
+{
+	return static_cast<T*>(_pool->allocate(count*sizeof(T)));
+}
+
+template<typename T>
+void PoolAllocator<T>::deallocate(T* buffer, std::size_t count) noexcept
+{
+	_pool->deallocate(buffer, count*sizeof(T));
+}
+
+template<typename T>
+BufferPool* PoolAllocator<T>::pool() const noexcept
+{
+	return _pool;
+}
+
+template<typename T, typename TOther>
+bool operator==(const PoolAllocator<T>& first, const PoolAllocator<TOther>& second) noexcept
+{
+	return first.pool() == second.pool();
+}
+
+template<typename T, typename TOther>
+bool operator!=(const PoolAllocator<T>& first, const PoolAllocator<TOther>& second) noexcept
+{
+	return !(first == second);
+}
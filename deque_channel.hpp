@@ -0,0 +1,163 @@
+#ifndef DEQUE_CHANNEL_HPP
+#define DEQUE_CHANNEL_HPP
+
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include "deque.hpp"
+
+//the awaitable push and pop need C++20 coroutines, the blocking thread API does not
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+#define DEQUE_COROUTINES 1
+#include <coroutine>
+#else
+#define DEQUE_COROUTINES 0
+#endif
+
+
+//bounded multi producer/multi consumer channel over a Deque.
+//a push into a full channel waits for room, a pop from an empty one waits
+//for an element, either as a blocked thread or as a suspended coroutine.
+//waiters are queued in FIFO order as intrusive nodes living on the waiting
+//thread's stack or in the coroutine frame, and a push or pop hands the
+//element to the first of them directly, so nothing is allocated once the
+//ring has reached the capacity. a capacity of 0 makes every push wait
+//for a pop to meet it.
+//a coroutine woken by a push or pop is resumed on the thread that did it.
+template<typename T>
+class DequeChannel
+{
+public:
+	using size_type = std::size_t;
+	using value_type = T;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+
+	explicit DequeChannel(size_type);
+
+	DequeChannel(const DequeChannel<T>&) = delete;
+	DequeChannel<T>& operator=(const DequeChannel<T>&) = delete;
+
+	//elements buffered in the ring, not counting those offered by waiting pushes
+	size_type size() const;
+	size_type capacity() const;
+
+	bool try_push(const_reference);
+	bool try_push(value_type&&);
+	bool try_pop(reference);
+
+	//blocks the calling thread until the element is taken in or handed over
+	void push_wait(value_type);
+	void pop_wait(reference);
+	//false if nothing arrived before the timeout, leaving value untouched
+	template<typename TRep, typename TPeriod>
+	bool pop_wait(reference, std::chrono::duration<TRep, TPeriod>);
+
+private:
+	struct _Waiter
+	{
+		_Waiter();
+		~_Waiter();
+
+		T& value();
+
+		_Waiter* next;
+		//set once the element is delivered to a pop or taken from a push
+		bool ready;
+		//a pop receives into the slot, a push offers its own value
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type slot;
+		bool filled;
+		T* offered;
+		std::shared_ptr<std::condition_variable> thread;
+#if DEQUE_COROUTINES
+		std::coroutine_handle<> coroutine;
+#endif
+	};
+
+	//whom to notify or resume once the lock is released
+	struct _Wakeup
+	{
+		std::shared_ptr<std::condition_variable> thread;
+#if DEQUE_COROUTINES
+		std::coroutine_handle<> coroutine;
+#endif
+	};
+
+	struct _WaitList
+	{
+		_WaitList();
+
+		bool empty() const;
+		void push(_Waiter*);
+		_Waiter* pop();
+		void remove(_Waiter*);
+
+		_Waiter* head;
+		_Waiter* tail;
+	};
+
+	//both run under the lock. they return false when the caller has to queue
+	bool _give(T&, _Wakeup&);
+	bool _take(_Waiter&, _Wakeup&);
+
+	static void _wake(_Waiter*, _Wakeup&);
+	static void _resume(_Wakeup&);
+
+	//a thread waits on its own condition variable, kept alive by every waker
+	//holding it, so that it can be notified after the lock is released
+	static const std::shared_ptr<std::condition_variable>& _thread_wakeup();
+
+	//waits without a deadline when given nullptr
+	bool _pop_wait(reference, const std::chrono::steady_clock::time_point*);
+
+	mutable std::mutex _mutex;
+	Deque<T, GrowthPolicy<2, 0>> _items;
+	size_type _capacity;
+	_WaitList _pushers;
+	_WaitList _poppers;
+
+#if DEQUE_COROUTINES
+public:
+	class PushAwaiter
+	{
+	public:
+		PushAwaiter(DequeChannel<T>&, value_type&&);
+
+		bool await_ready() const noexcept;
+		bool await_suspend(std::coroutine_handle<>);
+		void await_resume() const noexcept;
+
+	private:
+		DequeChannel<T>& _channel;
+		value_type _value;
+		_Waiter _node;
+	};
+
+	class PopAwaiter
+	{
+	public:
+		explicit PopAwaiter(DequeChannel<T>&);
+
+		bool await_ready() const noexcept;
+		bool await_suspend(std::coroutine_handle<>);
+		value_type await_resume();
+
+	private:
+		DequeChannel<T>& _channel;
+		_Waiter _node;
+	};
+
+	//co_await channel.push(value) suspends while the channel is full,
+	//co_await channel.pop() while it is empty
+	PushAwaiter push(value_type);
+	PopAwaiter pop();
+#endif
+};
+
+#include "deque_channel.tpp"
+
+#endif //DEQUE_CHANNEL_HPP
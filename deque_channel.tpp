@@ -0,0 +1,375 @@
+#include "deque_channel.hpp"
+
+template<typename T>
+DequeChannel<T>::_Waiter::_Waiter()
+	: next(nullptr), ready(false), filled(false), offered(nullptr)
+{
+
+}
+
+template<typename T>
+DequeChannel<T>::_Waiter::~_Waiter()
+{
+	if (filled)
+		value().~T();
+}
+
+template<typename T>
+T& DequeChannel<T>::_Waiter::value()
+{
+	return *reinterpret_cast<T*>(&slot);
+}
+
+template<typename T>
+DequeChannel<T>::_WaitList::_WaitList()
+	: head(nullptr), tail(nullptr)
+{
+
+}
+
+template<typename T>
+bool DequeChannel<T>::_WaitList::empty() const
+{
+	return head == nullptr;
+}
+
+template<typename T>
+void DequeChannel<T>::_WaitList::push(typename DequeChannel<T>::_Waiter* waiter)
+{
+	waiter->next = nullptr;
+	if (tail == nullptr)
+		head = waiter;
+	else
+		tail->next = waiter;
+	tail = waiter;
+}
+
+template<typename T>
+typename DequeChannel<T>::_Waiter* DequeChannel<T>::_WaitList::pop()
+{
+	_Waiter* waiter = head;
+	head = waiter->next;
+	if (head == nullptr)
+		tail = nullptr;
+	return waiter;
+}
+
+template<typename T>
+void DequeChannel<T>::_WaitList::remove(typename DequeChannel<T>::_Waiter* waiter)
+{
+	_Waiter* previous = nullptr;
+	for (_Waiter* current = head; current != nullptr; previous = current, current = current->next)
+	{
+		if (current != waiter)
+			continue;
+		if (previous == nullptr)
+			head = current->next;
+		else
+			previous->next = current->next;
+		if (tail == current)
+			tail = previous;
+		return;
+	}
+}
+
+template<typename T>
+DequeChannel<T>::DequeChannel(typename DequeChannel<T>::size_type capacity)
+	: _capacity(capacity)
+{
+	_items.reserve(capacity);
+}
+
+template<typename T>
+typename DequeChannel<T>::size_type DequeChannel<T>::size() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _items.size();
+}
+
+template<typename T>
+typename DequeChannel<T>::size_type DequeChannel<T>::capacity() const
+{
+	return _capacity;
+}
+
+template<typename T>
+bool DequeChannel<T>::try_push(typename DequeChannel<T>::const_reference value)
+{
+	T copy(value);
+	return try_push(std::move(copy));
+}
+
+template<typename T>
+bool DequeChannel<T>::try_push(typename DequeChannel<T>::value_type&& value)
+{
+	_Wakeup woken;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_give(value, woken))
+			return false;
+	}
+	_resume(woken);
+	return true;
+}
+
+template<typename T>
+bool DequeChannel<T>::try_pop(typename DequeChannel<T>::reference value)
+{
+	_Waiter node;
+	_Wakeup woken;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_take(node, woken))
+			return false;
+	}
+	value = std::move(node.value());
+	_resume(woken);
+	return true;
+}
+
+//the waiting threads queue nodes from their own stack, which gcc 12 flags
+//although every node is unlinked before its thread returns
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdangling-pointer"
+#endif
+
+template<typename T>
+void DequeChannel<T>::push_wait(typename DequeChannel<T>::value_type value)
+{
+	_Wakeup woken;
+	std::unique_lock<std::mutex> lock(_mutex);
+	if (_give(value, woken))
+	{
+		lock.unlock();
+		_resume(woken);
+		return;
+	}
+
+	std::condition_variable& wakeup = *_thread_wakeup();
+	_Waiter node;
+	node.offered = &value;
+	node.thread = _thread_wakeup();
+	_pushers.push(&node);
+	while (!node.ready)
+		wakeup.wait(lock);
+}
+
+template<typename T>
+void DequeChannel<T>::pop_wait(typename DequeChannel<T>::reference value)
+{
+	_pop_wait(value, nullptr);
+}
+
+template<typename T>
+template<typename TRep, typename TPeriod>
+bool DequeChannel<T>::pop_wait(typename DequeChannel<T>::reference value,
+	std::chrono::duration<TRep, TPeriod> timeout)
+{
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+		+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+	return _pop_wait(value, &deadline);
+}
+
+template<typename T>
+bool DequeChannel<T>::_pop_wait(typename DequeChannel<T>::reference value,
+	const std::chrono::steady_clock::time_point* deadline)
+{
+	_Waiter node;
+	_Wakeup woken;
+	std::unique_lock<std::mutex> lock(_mutex);
+	if (_take(node, woken))
+	{
+		lock.unlock();
+		value = std::move(node.value());
+		_resume(woken);
+		return true;
+	}
+
+	std::condition_variable& wakeup = *_thread_wakeup();
+	node.thread = _thread_wakeup();
+	_poppers.push(&node);
+	while (!node.ready)
+	{
+		if (deadline == nullptr)
+			wakeup.wait(lock);
+		else if (wakeup.wait_until(lock, *deadline) == std::cv_status::timeout && !node.ready)
+		{
+			_poppers.remove(&node);
+			return false;
+		}
+	}
+	lock.unlock();
+	value = std::move(node.value());
+	return true;
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic pop
+#endif
+
+template<typename T>
+bool DequeChannel<T>::_give(T& value, typename DequeChannel<T>::_Wakeup& woken)
+{
+	if (!_poppers.empty())
+	{
+		//the ring is empty whenever a pop waits, so the element skips it
+		_Waiter* popper = _poppers.pop();
+		new (&popper->slot) T(std::move(value));
+		popper->filled = true;
+		_wake(popper, woken);
+		return true;
+	}
+	if (_items.size() < _capacity)
+	{
+		_items.push_back(std::move(value));
+		return true;
+	}
+	return false;
+}
+
+template<typename T>
+bool DequeChannel<T>::_take(typename DequeChannel<T>::_Waiter& receiver,
+	typename DequeChannel<T>::_Wakeup& woken)
+{
+	if (_items.empty() && _pushers.empty())
+		return false;
+
+	_Waiter* pusher = _pushers.empty() ? nullptr : _pushers.pop();
+	if (_items.empty())
+		new (&receiver.slot) T(std::move(*pusher->offered));
+	else
+	{
+		//the oldest waiting push takes the room the pop leaves
+		new (&receiver.slot) T(std::move(_items.front()));
+		_items.pop_front();
+		if (pusher != nullptr)
+			_items.push_back(std::move(*pusher->offered));
+	}
+	receiver.filled = true;
+	if (pusher != nullptr)
+		_wake(pusher, woken);
+	return true;
+}
+
+template<typename T>
+void DequeChannel<T>::_wake(typename DequeChannel<T>::_Waiter* waiter,
+	typename DequeChannel<T>::_Wakeup& woken)
+{
+	//the waiter may be gone as soon as the lock is released, so everything
+	//needed to wake it is taken out now
+	waiter->ready = true;
+	woken.thread = std::move(waiter->thread);
+#if DEQUE_COROUTINES
+	woken.coroutine = waiter->coroutine;
+#endif
+}
+
+template<typename T>
+void DequeChannel<T>::_resume(typename DequeChannel<T>::_Wakeup& woken)
+{
+	if (woken.thread)
+		woken.thread->notify_one();
+#if DEQUE_COROUTINES
+	else if (woken.coroutine)
+		woken.coroutine.resume();
+#endif
+}
+
+template<typename T>
+const std::shared_ptr<std::condition_variable>& DequeChannel<T>::_thread_wakeup()
+{
+	static thread_local std::shared_ptr<std::condition_variable> wakeup(
+		std::make_shared<std::condition_variable>());
+	return wakeup;
+}
+
+#if DEQUE_COROUTINES
+template<typename T>
+DequeChannel<T>::PushAwaiter::PushAwaiter(DequeChannel<T>& channel,
+	typename DequeChannel<T>::value_type&& value)
+	: _channel(channel), _value(std::move(value))
+{
+
+}
+
+template<typename T>
+bool DequeChannel<T>::PushAwaiter::await_ready() const noexcept
+{
+	return false;
+}
+
+template<typename T>
+bool DequeChannel<T>::PushAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+{
+	_Wakeup woken;
+	{
+		std::lock_guard<std::mutex> lock(_channel._mutex);
+		if (!_channel._give(_value, woken))
+		{
+			//the awaiter must not be touched once it is queued, a pop on
+			//another thread may resume the coroutine before the lock is released
+			_node.offered = &_value;
+			_node.coroutine = coroutine;
+			_channel._pushers.push(&_node);
+			return true;
+		}
+	}
+	_resume(woken);
+	return false;
+}
+
+template<typename T>
+void DequeChannel<T>::PushAwaiter::await_resume() const noexcept
+{
+
+}
+
+template<typename T>
+DequeChannel<T>::PopAwaiter::PopAwaiter(DequeChannel<T>& channel)
+	: _channel(channel)
+{
+
+}
+
+template<typename T>
+bool DequeChannel<T>::PopAwaiter::await_ready() const noexcept
+{
+	return false;
+}
+
+template<typename T>
+bool DequeChannel<T>::PopAwaiter::await_suspend(std::coroutine_handle<> coroutine)
+{
+	_Wakeup woken;
+	{
+		std::lock_guard<std::mutex> lock(_channel._mutex);
+		if (!_channel._take(_node, woken))
+		{
+			_node.coroutine = coroutine;
+			_channel._poppers.push(&_node);
+			return true;
+		}
+	}
+	_resume(woken);
+	return false;
+}
+
+template<typename T>
+typename DequeChannel<T>::value_type DequeChannel<T>::PopAwaiter::await_resume()
+{
+	return std::move(_node.value());
+}
+
+template<typename T>
+typename DequeChannel<T>::PushAwaiter DequeChannel<T>::push(typename DequeChannel<T>::value_type value)
+{
+	return PushAwaiter(*this, std::move(value));
+}
+
+template<typename T>
+typename DequeChannel<T>::PopAwaiter DequeChannel<T>::pop()
+{
+	return PopAwaiter(*this);
+}
+#endif
@@ -0,0 +1,110 @@
+#ifndef DEQUE_PERSISTENCE_HPP
+#define DEQUE_PERSISTENCE_HPP
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "deque.hpp"
+
+
+//binary snapshots of a deque of trivially copyable elements: a small header,
+//then the raw bytes of the ring's contiguous runs. the format is the machine's
+//own layout, it is not meant to move between architectures.
+//both throw std::runtime_error when the stream fails or holds something else
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+void save_deque(std::ostream&, const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&);
+
+//replaces the contents, reading every element straight into the buffer
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+void load_deque(std::istream&, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>&);
+
+//the same ring as Deque, kept in a memory-mapped file together with its
+//start, size and capacity, so that reopening the file restores the contents
+//without reading them. every change lands in the page cache right away and survives
+//the process being killed between operations; sync() flushes it to the disk.
+//the capacity is a power of two and only ever grows, by extending the file.
+//POSIX only, for trivially copyable T
+template<typename T>
+class MappedDeque
+{
+public:
+	using size_type = std::size_t;
+	using value_type = T;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+
+	//opens the file or creates it with room for at least min_capacity elements.
+	//throws std::runtime_error if the file can not be mapped or holds something else
+	explicit MappedDeque(const std::string& path, size_type min_capacity = 1024);
+	MappedDeque(const MappedDeque<T>&) = delete;
+	MappedDeque<T>& operator=(const MappedDeque<T>&) = delete;
+
+	bool empty() const;
+	size_type size() const;
+	size_type capacity() const;
+
+	void push_back(const_reference);
+	void push_front(const_reference);
+	void pop_back();
+	void pop_front();
+	void clear();
+
+	reference operator[](size_type);
+	const_reference operator[](size_type) const;
+
+	reference front();
+	const_reference front() const;
+	reference back();
+	const_reference back() const;
+
+	void sync();
+
+	~MappedDeque();
+
+private:
+	struct _State
+	{
+		std::uint64_t capacity;
+		std::uint64_t start;
+		std::uint64_t size;
+	};
+
+	//the first bytes of the file. a change writes the state slot that is not
+	//current and then flips current, so a single store publishes it and a
+	//process killed halfway leaves the previous state intact
+	struct _Header
+	{
+		char magic[8];
+		std::uint64_t element_size;
+		std::uint64_t current;
+		_State states[2];
+	};
+
+	//the elements start on a cache line of their own
+	static const size_type HEADER_SIZE = 128;
+
+	const _State& _state() const;
+	void _commit(const _State&);
+	void _map(size_type bytes);
+	void _resize_file(size_type capacity);
+	void _grow();
+	void _close();
+	size_type _index(size_type) const;
+	T* _data() const;
+
+	int _fd;
+	void* _mapping;
+	size_type _mapped_bytes;
+	_Header* _header;
+
+	static_assert(std::is_trivially_copyable<T>::value,
+		"Only trivially copyable elements can live in a file");
+	static_assert(sizeof(_Header) <= HEADER_SIZE && alignof(T) <= HEADER_SIZE, 
+		"The header must fit before the elements");
+};
+
+#include "deque_persistence.tpp"
+
+#endif //DEQUE_PERSISTENCE_HPP
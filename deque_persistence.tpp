@@ -0,0 +1,309 @@
+#include "deque_persistence.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//"DEQBIN01" for streams, "DEQMAP01" for mapped files
+static const char DEQUE_STREAM_MAGIC[8] = {'D', 'E', 'Q', 'B', 'I', 'N', '0', '1'};
+static const char DEQUE_MAPPED_MAGIC[8] = {'D', 'E', 'Q', 'M', 'A', 'P', '0', '1'};
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+void save_deque(std::ostream& out, const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& deq)
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+		"Only trivially copyable elements can be saved as bytes");
+
+	std::uint64_t header[2] = {sizeof(T), deq.size()};
+	out.write(DEQUE_STREAM_MAGIC, sizeof(DEQUE_STREAM_MAGIC));
+	out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	auto spans = deq.as_spans();
+	out.write(reinterpret_cast<const char*>(spans.first.data), spans.first.size*sizeof(T));
+	out.write(reinterpret_cast<const char*>(spans.second.data), spans.second.size*sizeof(T));
+	if (!out)
+		throw std::runtime_error("Can not write the deque");
+}
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+void load_deque(std::istream& in, Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& deq)
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+		"Only trivially copyable elements can be loaded from bytes");
+
+	char magic[sizeof(DEQUE_STREAM_MAGIC)];
+	std::uint64_t header[2];
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!in || std::memcmp(magic, DEQUE_STREAM_MAGIC, sizeof(magic)) != 0)
+		throw std::runtime_error("Not a saved deque");
+	if (header[0] != sizeof(T))
+		throw std::runtime_error("Saved deque holds elements of another size");
+
+	deq.clear();
+	std::size_t count = header[1];
+	auto span = deq.reserve_back_span(count);
+	in.read(reinterpret_cast<char*>(span.data), count*sizeof(T));
+	if (!in)
+	{
+		deq.clear();
+		throw std::runtime_error("Saved deque is truncated");
+	}
+	deq.commit_back(count);
+}
+
+// ==================== MAPPED DEQUE =======================
+
+template<typename T>
+MappedDeque<T>::MappedDeque(const std::string& path, MappedDeque<T>::size_type min_capacity)
+	: _fd(-1), _mapping(nullptr), _mapped_bytes(0), _header(nullptr)
+{
+	_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (_fd < 0)
+		throw std::runtime_error("Can not open " + path + ": " + std::strerror(errno));
+
+	try
+	{
+		struct stat info;
+		if (::fstat(_fd, &info) != 0)
+			throw std::runtime_error("Can not stat " + path + ": " + std::strerror(errno));
+
+		if (info.st_size == 0)
+		{
+			size_type capacity = 1;
+			while (capacity < min_capacity)
+				capacity *= 2;
+			_resize_file(capacity);
+			_map(HEADER_SIZE + capacity*sizeof(T));
+			std::memcpy(_header->magic, DEQUE_MAPPED_MAGIC, sizeof(DEQUE_MAPPED_MAGIC));
+			_header->element_size = sizeof(T);
+			_header->current = 0;
+			_header->states[0] = _State{capacity, 0, 0};
+			return;
+		}
+
+		if (size_type(info.st_size) < HEADER_SIZE)
+			throw std::runtime_error("Not a mapped deque: " + path);
+		_map(info.st_size);
+		const _State& state = _state();
+		bool valid = std::memcmp(_header->magic, DEQUE_MAPPED_MAGIC, sizeof(DEQUE_MAPPED_MAGIC)) == 0
+			&& _header->element_size == sizeof(T) && _header->current < 2
+			&& state.capacity > 0 && (state.capacity & (state.capacity - 1)) == 0
+			&& HEADER_SIZE + state.capacity*sizeof(T) <= size_type(info.st_size)
+			&& state.start < state.capacity && state.size <= state.capacity;
+		if (!valid)
+			throw std::runtime_error("Not a mapped deque of this type: " + path);
+	}
+	catch (...)
+	{
+		_close();
+		throw;
+	}
+}
+
+template<typename T>
+bool MappedDeque<T>::empty() const
+{
+	return _state().size == 0;
+}
+
+template<typename T>
+typename MappedDeque<T>::size_type MappedDeque<T>::size() const
+{
+	return _state().size;
+}
+
+template<typename T>
+typename MappedDeque<T>::size_type MappedDeque<T>::capacity() const
+{
+	return _state().capacity;
+}
+
+template<typename T>
+void MappedDeque<T>::push_back(typename MappedDeque<T>::const_reference value)
+{
+	if (_state().size == _state().capacity)
+		_grow();
+	_State state = _state();
+	_data()[_index(state.size)] = value;
+	++state.size;
+	_commit(state);
+}
+
+template<typename T>
+void MappedDeque<T>::push_front(typename MappedDeque<T>::const_reference value)
+{
+	if (_state().size == _state().capacity)
+		_grow();
+	_State state = _state();
+	state.start = (state.start + state.capacity - 1) & (state.capacity - 1);
+	_data()[state.start] = value;
+	++state.size;
+	_commit(state);
+}
+
+template<typename T>
+void MappedDeque<T>::pop_back()
+{
+	_State state = _state();
+	--state.size;
+	_commit(state);
+}
+
+template<typename T>
+void MappedDeque<T>::pop_front()
+{
+	_State state = _state();
+	state.start = (state.start + 1) & (state.capacity - 1);
+	--state.size;
+	_commit(state);
+}
+
+template<typename T>
+void MappedDeque<T>::clear()
+{
+	_State state = _state();
+	state.start = 0;
+	state.size = 0;
+	_commit(state);
+}
+
+template<typename T>
+typename MappedDeque<T>::reference MappedDeque<T>::operator[](MappedDeque<T>::size_type index)
+{
+	return _data()[_index(index)];
+}
+
+template<typename T>
+typename MappedDeque<T>::const_reference MappedDeque<T>::operator[](MappedDeque<T>::size_type index) const
+{
+	return _data()[_index(index)];
+}
+
+template<typename T>
+typename MappedDeque<T>::reference MappedDeque<T>::front()
+{
+	return operator[](0);
+}
+
+template<typename T>
+typename MappedDeque<T>::const_reference MappedDeque<T>::front() const
+{
+	return operator[](0);
+}
+
+template<typename T>
+typename MappedDeque<T>::reference MappedDeque<T>::back()
+{
+	return operator[](size() - 1);
+}
+
+template<typename T>
+typename MappedDeque<T>::const_reference MappedDeque<T>::back() const
+{
+	return operator[](size() - 1);
+}
+
+template<typename T>
+void MappedDeque<T>::sync()
+{
+	if (::msync(_mapping, _mapped_bytes, MS_SYNC) != 0)
+		throw std::runtime_error(std::string("Can not sync the mapped deque: ") + std::strerror(errno));
+}
+
+template<typename T>
+MappedDeque<T>::~MappedDeque()
+{
+	_close();
+}
+
+template<typename T>
+const typename MappedDeque<T>::_State& MappedDeque<T>::_state() const
+{
+	return _header->states[_header->current];
+}
+
+template<typename T>
+void MappedDeque<T>::_commit(const typename MappedDeque<T>::_State& state)
+{
+	//the elements and the spare slot must be written before the flip
+	std::uint64_t next = 1 - _header->current;
+	std::atomic_signal_fence(std::memory_order_release);
+	_header->states[next] = state;
+	std::atomic_signal_fence(std::memory_order_release);
+	_header->current = next;
+}
+
+template<typename T>
+void MappedDeque<T>::_map(MappedDeque<T>::size_type bytes)
+{
+	if (_mapping != nullptr)
+		::munmap(_mapping, _mapped_bytes);
+	_header = nullptr;
+	_mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+	if (_mapping == MAP_FAILED)
+	{
+		_mapping = nullptr;
+		_mapped_bytes = 0;
+		throw std::runtime_error(std::string("Can not map the deque: ") + std::strerror(errno));
+	}
+	_mapped_bytes = bytes;
+	_header = static_cast<_Header*>(_mapping);
+}
+
+template<typename T>
+void MappedDeque<T>::_resize_file(MappedDeque<T>::size_type capacity)
+{
+	if (::ftruncate(_fd, HEADER_SIZE + capacity*sizeof(T)) != 0)
+		throw std::runtime_error(std::string("Can not extend the deque file: ") + std::strerror(errno));
+}
+
+template<typename T>
+void MappedDeque<T>::_grow()
+{
+	//the wrapped part [0, start + size - capacity) is copied right after the old end,
+	//the old copy stays valid until the new capacity is committed
+	_State state = _state();
+	size_type capacity = 2*state.capacity;
+	_resize_file(capacity);
+	_map(HEADER_SIZE + capacity*sizeof(T));
+
+	if (state.start + state.size > state.capacity)
+	{
+		T* data = _data();
+		std::memcpy(data + state.capacity, data,
+			(state.start + state.size - state.capacity)*sizeof(T));
+	}
+	state.capacity = capacity;
+	_commit(state);
+}
+
+template<typename T>
+void MappedDeque<T>::_close()
+{
+	if (_mapping != nullptr)
+		::munmap(_mapping, _mapped_bytes);
+	if (_fd >= 0)
+		::close(_fd);
+	_mapping = nullptr;
+	_header = nullptr;
+	_fd = -1;
+}
+
+template<typename T>
+typename MappedDeque<T>::size_type MappedDeque<T>::_index(MappedDeque<T>::size_type index) const
+{
+	const _State& state = _state();
+	return (state.start + index) & (state.capacity - 1);
+}
+
+template<typename T>
+T* MappedDeque<T>::_data() const
+{
+	return reinterpret_cast<T*>(static_cast<char*>(_mapping) + HEADER_SIZE);
+}
@@ -0,0 +1,101 @@
+#ifndef DEQUE_SIMD_HPP
+#define DEQUE_SIMD_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include "deque.hpp"
+#include "deque_algorithm.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DEQUE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+
+//explicitly vectorized kernels for Deque<int> and Deque<float>, run over each
+//contiguous run of the ring. the AVX2 and SSE2 versions are compiled with target
+//attributes and picked at runtime from what the CPU supports, other
+//architectures always take the scalar loop
+
+enum class SimdLevel
+{
+	Scalar,
+	Sse2,
+	Avx2
+};
+
+//the best level the CPU supports, detected once
+SimdLevel simd_supported_level();
+
+//the level the algorithms below dispatch to. set_simd_level clamps to the supported
+//one; it exists to compare the kernels in tests and benchmarks and is not thread-safe
+SimdLevel simd_level();
+void set_simd_level(SimdLevel);
+
+const char* simd_level_name(SimdLevel);
+
+template<typename T>
+struct _simd_kernels;
+
+//ints are summed in 64-bit lanes, so the sum does not overflow
+template<>
+struct _simd_kernels<int>
+{
+	using sum_type = long long;
+
+	static sum_type sum(const int*, std::size_t, SimdLevel);
+	static int min(const int*, std::size_t, SimdLevel);
+	static int max(const int*, std::size_t, SimdLevel);
+	static std::size_t find(const int*, std::size_t, int, SimdLevel);
+	static std::size_t count(const int*, std::size_t, int, SimdLevel);
+	static void fill(int*, std::size_t, int, SimdLevel);
+	//multiplication wraps around like unsigned arithmetic
+	static void transform(int*, std::size_t, int, int, SimdLevel);
+};
+
+//floats are summed in doubles, in a different order than std::accumulate.
+//min and max of a range holding NaN are unspecified
+template<>
+struct _simd_kernels<float>
+{
+	using sum_type = double;
+
+	static sum_type sum(const float*, std::size_t, SimdLevel);
+	static float min(const float*, std::size_t, SimdLevel);
+	static float max(const float*, std::size_t, SimdLevel);
+	static std::size_t find(const float*, std::size_t, float, SimdLevel);
+	static std::size_t count(const float*, std::size_t, float, SimdLevel);
+	static void fill(float*, std::size_t, float, SimdLevel);
+	static void transform(float*, std::size_t, float, float, SimdLevel);
+};
+
+template<typename TValue>
+using _simd_kernels_for = _simd_kernels<typename std::remove_const<TValue>::type>;
+
+template<typename TValue>
+typename _simd_kernels_for<TValue>::sum_type simd_sum(_ring_iterator<TValue>, _ring_iterator<TValue>);
+
+//the range must not be empty
+template<typename TValue>
+typename std::remove_const<TValue>::type simd_min(_ring_iterator<TValue>, _ring_iterator<TValue>);
+template<typename TValue>
+typename std::remove_const<TValue>::type simd_max(_ring_iterator<TValue>, _ring_iterator<TValue>);
+
+template<typename TValue>
+_ring_iterator<TValue> simd_find(_ring_iterator<TValue>, _ring_iterator<TValue>,
+	typename std::remove_const<TValue>::type);
+
+template<typename TValue>
+std::ptrdiff_t simd_count(_ring_iterator<TValue>, _ring_iterator<TValue>,
+	typename std::remove_const<TValue>::type);
+
+template<typename TValue>
+void simd_fill(_ring_iterator<TValue>, _ring_iterator<TValue>, TValue);
+
+//x = x*multiplier + addend for every element of the range
+template<typename TValue>
+void simd_transform(_ring_iterator<TValue>, _ring_iterator<TValue>, TValue multiplier, TValue addend);
+
+#include "deque_simd.tpp"
+
+#endif //DEQUE_SIMD_HPP
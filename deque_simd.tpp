@@ -0,0 +1,685 @@
+#include "deque_simd.hpp"
+
+#ifdef DEQUE_SIMD_X86
+#define DEQUE_TARGET_SSE2 __attribute__((target("sse2")))
+#define DEQUE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+inline SimdLevel _detect_simd_level()
+{
+#ifdef DEQUE_SIMD_X86
+	__builtin_cpu_init();
+	//also checks that the OS saves the ymm registers
+	if (__builtin_cpu_supports("avx2"))
+		return SimdLevel::Avx2;
+	if (__builtin_cpu_supports("sse2"))
+		return SimdLevel::Sse2;
+#endif
+	return SimdLevel::Scalar;
+}
+
+inline SimdLevel& _current_simd_level()
+{
+	static SimdLevel level = simd_supported_level();
+	return level;
+}
+
+inline SimdLevel simd_supported_level()
+{
+	static const SimdLevel level = _detect_simd_level();
+	return level;
+}
+
+inline SimdLevel simd_level()
+{
+	return _current_simd_level();
+}
+
+inline void set_simd_level(SimdLevel level)
+{
+	_current_simd_level() = std::min(level, simd_supported_level());
+}
+
+inline const char* simd_level_name(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::Avx2:
+		return "avx2";
+	case SimdLevel::Sse2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
+
+// ==================== SCALAR =======================
+
+//also finish the tails the vector loops leave behind
+
+template<typename TSum, typename T>
+TSum _scalar_sum(const T* data, std::size_t count)
+{
+	TSum result = 0;
+	for (std::size_t i = 0; i < count; ++i)
+		result += data[i];
+	return result;
+}
+
+template<typename T>
+T _scalar_min(const T* data, std::size_t count, T result)
+{
+	for (std::size_t i = 0; i < count; ++i)
+		result = data[i] < result ? data[i] : result;
+	return result;
+}
+
+template<typename T>
+T _scalar_max(const T* data, std::size_t count, T result)
+{
+	for (std::size_t i = 0; i < count; ++i)
+		result = result < data[i] ? data[i] : result;
+	return result;
+}
+
+template<typename T>
+std::size_t _scalar_find(const T* data, std::size_t count, T value)
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (data[i] == value)
+			return i;
+	}
+	return count;
+}
+
+template<typename T>
+std::size_t _scalar_count(const T* data, std::size_t count, T value)
+{
+	std::size_t result = 0;
+	for (std::size_t i = 0; i < count; ++i)
+		result += data[i] == value;
+	return result;
+}
+
+template<typename T>
+void _scalar_fill(T* data, std::size_t count, T value)
+{
+	for (std::size_t i = 0; i < count; ++i)
+		data[i] = value;
+}
+
+inline void _scalar_transform(int* data, std::size_t count, int multiplier, int addend)
+{
+	for (std::size_t i = 0; i < count; ++i)
+		data[i] = int(unsigned(data[i])*unsigned(multiplier) + unsigned(addend));
+}
+
+inline void _scalar_transform(float* data, std::size_t count, float multiplier, float addend)
+{
+	for (std::size_t i = 0; i < count; ++i)
+		data[i] = data[i]*multiplier + addend;
+}
+
+#ifdef DEQUE_SIMD_X86
+
+// ==================== SSE2 =======================
+
+DEQUE_TARGET_SSE2 inline long long _sse2_sum(const int* data, std::size_t count)
+{
+	//sign-extends each half of the vector into 64-bit lanes
+	__m128i total = _mm_setzero_si128();
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		__m128i sign = _mm_srai_epi32(value, 31);
+		total = _mm_add_epi64(total, _mm_unpacklo_epi32(value, sign));
+		total = _mm_add_epi64(total, _mm_unpackhi_epi32(value, sign));
+	}
+	long long lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+	return lanes[0] + lanes[1] + _scalar_sum<long long>(data + i, count - i);
+}
+
+DEQUE_TARGET_SSE2 inline double _sse2_sum(const float* data, std::size_t count)
+{
+	__m128d total = _mm_setzero_pd();
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 value = _mm_loadu_ps(data + i);
+		total = _mm_add_pd(total, _mm_cvtps_pd(value));
+		total = _mm_add_pd(total, _mm_cvtps_pd(_mm_movehl_ps(value, value)));
+	}
+	double lanes[2];
+	_mm_storeu_pd(lanes, total);
+	return lanes[0] + lanes[1] + _scalar_sum<double>(data + i, count - i);
+}
+
+//SSE2 has no 32-bit integer min, max or multiply, they are built from compares and shuffles
+DEQUE_TARGET_SSE2 inline __m128i _sse2_select(__m128i mask, __m128i first, __m128i second)
+{
+	return _mm_or_si128(_mm_and_si128(mask, first), _mm_andnot_si128(mask, second));
+}
+
+DEQUE_TARGET_SSE2 inline __m128i _sse2_mullo(__m128i first, __m128i second)
+{
+	__m128i even = _mm_mul_epu32(first, second);
+	__m128i odd = _mm_mul_epu32(_mm_srli_si128(first, 4), _mm_srli_si128(second, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+DEQUE_TARGET_SSE2 inline int _sse2_min(const int* data, std::size_t count)
+{
+	if (count < 4)
+		return _scalar_min(data + 1, count - 1, data[0]);
+	__m128i result = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+	std::size_t i = 4;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		result = _sse2_select(_mm_cmplt_epi32(value, result), value, result);
+	}
+	int lanes[4];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), result);
+	return _scalar_min(data + i, count - i, _scalar_min(lanes + 1, 3, lanes[0]));
+}
+
+DEQUE_TARGET_SSE2 inline int _sse2_max(const int* data, std::size_t count)
+{
+	if (count < 4)
+		return _scalar_max(data + 1, count - 1, data[0]);
+	__m128i result = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+	std::size_t i = 4;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		result = _sse2_select(_mm_cmpgt_epi32(value, result), value, result);
+	}
+	int lanes[4];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), result);
+	return _scalar_max(data + i, count - i, _scalar_max(lanes + 1, 3, lanes[0]));
+}
+
+DEQUE_TARGET_SSE2 inline float _sse2_min(const float* data, std::size_t count)
+{
+	if (count < 4)
+		return _scalar_min(data + 1, count - 1, data[0]);
+	__m128 result = _mm_loadu_ps(data);
+	std::size_t i = 4;
+	for (; i + 4 <= count; i += 4)
+		result = _mm_min_ps(_mm_loadu_ps(data + i), result);
+	float lanes[4];
+	_mm_storeu_ps(lanes, result);
+	return _scalar_min(data + i, count - i, _scalar_min(lanes + 1, 3, lanes[0]));
+}
+
+DEQUE_TARGET_SSE2 inline float _sse2_max(const float* data, std::size_t count)
+{
+	if (count < 4)
+		return _scalar_max(data + 1, count - 1, data[0]);
+	__m128 result = _mm_loadu_ps(data);
+	std::size_t i = 4;
+	for (; i + 4 <= count; i += 4)
+		result = _mm_max_ps(_mm_loadu_ps(data + i), result);
+	float lanes[4];
+	_mm_storeu_ps(lanes, result);
+	return _scalar_max(data + i, count - i, _scalar_max(lanes + 1, 3, lanes[0]));
+}
+
+DEQUE_TARGET_SSE2 inline int _sse2_equal_mask(const int* data, __m128i value)
+{
+	__m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), value);
+	return _mm_movemask_ps(_mm_castsi128_ps(equal));
+}
+
+DEQUE_TARGET_SSE2 inline int _sse2_equal_mask(const float* data, __m128 value)
+{
+	return _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data), value));
+}
+
+DEQUE_TARGET_SSE2 inline __m128i _sse2_broadcast(int value)
+{
+	return _mm_set1_epi32(value);
+}
+
+DEQUE_TARGET_SSE2 inline __m128 _sse2_broadcast(float value)
+{
+	return _mm_set1_ps(value);
+}
+
+template<typename T>
+DEQUE_TARGET_SSE2 std::size_t _sse2_find(const T* data, std::size_t count, T value)
+{
+	auto broadcast = _sse2_broadcast(value);
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		int mask = _sse2_equal_mask(data + i, broadcast);
+		if (mask != 0)
+			return i + __builtin_ctz(mask);
+	}
+	return i + _scalar_find(data + i, count - i, value);
+}
+
+//the table in the constant counts the bits of each 4-bit mask,
+//SSE2 machines may lack the popcnt instruction
+template<typename T>
+DEQUE_TARGET_SSE2 std::size_t _sse2_count(const T* data, std::size_t count, T value)
+{
+	auto broadcast = _sse2_broadcast(value);
+	std::size_t result = 0;
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		result += (0x4332322132212110ull >> 4*_sse2_equal_mask(data + i, broadcast)) & 0xf;
+	return result + _scalar_count(data + i, count - i, value);
+}
+
+DEQUE_TARGET_SSE2 inline void _sse2_fill(int* data, std::size_t count, int value)
+{
+	__m128i broadcast = _mm_set1_epi32(value);
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), broadcast);
+	_scalar_fill(data + i, count - i, value);
+}
+
+DEQUE_TARGET_SSE2 inline void _sse2_fill(float* data, std::size_t count, float value)
+{
+	__m128 broadcast = _mm_set1_ps(value);
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(data + i, broadcast);
+	_scalar_fill(data + i, count - i, value);
+}
+
+DEQUE_TARGET_SSE2 inline void _sse2_transform(int* data, std::size_t count, int multiplier, int addend)
+{
+	__m128i factor = _mm_set1_epi32(multiplier);
+	__m128i term = _mm_set1_epi32(addend);
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i* slot = reinterpret_cast<__m128i*>(data + i);
+		_mm_storeu_si128(slot, _mm_add_epi32(_sse2_mullo(_mm_loadu_si128(slot), factor), term));
+	}
+	_scalar_transform(data + i, count - i, multiplier, addend);
+}
+
+DEQUE_TARGET_SSE2 inline void _sse2_transform(float* data, std::size_t count, float multiplier, float addend)
+{
+	__m128 factor = _mm_set1_ps(multiplier);
+	__m128 term = _mm_set1_ps(addend);
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(data + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(data + i), factor), term));
+	_scalar_transform(data + i, count - i, multiplier, addend);
+}
+
+// ==================== AVX2 =======================
+
+DEQUE_TARGET_AVX2 inline long long _avx2_sum(const int* data, std::size_t count)
+{
+	__m256i total = _mm256_setzero_si256();
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(value)));
+		total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(value, 1)));
+	}
+	long long lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + _scalar_sum<long long>(data + i, count - i);
+}
+
+DEQUE_TARGET_AVX2 inline double _avx2_sum(const float* data, std::size_t count)
+{
+	__m256d total = _mm256_setzero_pd();
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		total = _mm256_add_pd(total, _mm256_cvtps_pd(_mm_loadu_ps(data + i)));
+		total = _mm256_add_pd(total, _mm256_cvtps_pd(_mm_loadu_ps(data + i + 4)));
+	}
+	double lanes[4];
+	_mm256_storeu_pd(lanes, total);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + _scalar_sum<double>(data + i, count - i);
+}
+
+DEQUE_TARGET_AVX2 inline int _avx2_min(const int* data, std::size_t count)
+{
+	if (count < 8)
+		return _scalar_min(data + 1, count - 1, data[0]);
+	__m256i result = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+	std::size_t i = 8;
+	for (; i + 8 <= count; i += 8)
+		result = _mm256_min_epi32(result, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+	int lanes[8];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), result);
+	return _scalar_min(data + i, count - i, _scalar_min(lanes + 1, 7, lanes[0]));
+}
+
+DEQUE_TARGET_AVX2 inline int _avx2_max(const int* data, std::size_t count)
+{
+	if (count < 8)
+		return _scalar_max(data + 1, count - 1, data[0]);
+	__m256i result = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+	std::size_t i = 8;
+	for (; i + 8 <= count; i += 8)
+		result = _mm256_max_epi32(result, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+	int lanes[8];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), result);
+	return _scalar_max(data + i, count - i, _scalar_max(lanes + 1, 7, lanes[0]));
+}
+
+DEQUE_TARGET_AVX2 inline float _avx2_min(const float* data, std::size_t count)
+{
+	if (count < 8)
+		return _scalar_min(data + 1, count - 1, data[0]);
+	__m256 result = _mm256_loadu_ps(data);
+	std::size_t i = 8;
+	for (; i + 8 <= count; i += 8)
+		result = _mm256_min_ps(_mm256_loadu_ps(data + i), result);
+	float lanes[8];
+	_mm256_storeu_ps(lanes, result);
+	return _scalar_min(data + i, count - i, _scalar_min(lanes + 1, 7, lanes[0]));
+}
+
+DEQUE_TARGET_AVX2 inline float _avx2_max(const float* data, std::size_t count)
+{
+	if (count < 8)
+		return _scalar_max(data + 1, count - 1, data[0]);
+	__m256 result = _mm256_loadu_ps(data);
+	std::size_t i = 8;
+	for (; i + 8 <= count; i += 8)
+		result = _mm256_max_ps(_mm256_loadu_ps(data + i), result);
+	float lanes[8];
+	_mm256_storeu_ps(lanes, result);
+	return _scalar_max(data + i, count - i, _scalar_max(lanes + 1, 7, lanes[0]));
+}
+
+DEQUE_TARGET_AVX2 inline int _avx2_equal_mask(const int* data, __m256i value)
+{
+	__m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), value);
+	return _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+}
+
+DEQUE_TARGET_AVX2 inline int _avx2_equal_mask(const float* data, __m256 value)
+{
+	return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data), value, _CMP_EQ_OQ));
+}
+
+DEQUE_TARGET_AVX2 inline __m256i _avx2_broadcast(int value)
+{
+	return _mm256_set1_epi32(value);
+}
+
+DEQUE_TARGET_AVX2 inline __m256 _avx2_broadcast(float value)
+{
+	return _mm256_set1_ps(value);
+}
+
+template<typename T>
+DEQUE_TARGET_AVX2 std::size_t _avx2_find(const T* data, std::size_t count, T value)
+{
+	auto broadcast = _avx2_broadcast(value);
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		int mask = _avx2_equal_mask(data + i, broadcast);
+		if (mask != 0)
+			return i + __builtin_ctz(mask);
+	}
+	return i + _scalar_find(data + i, count - i, value);
+}
+
+template<typename T>
+DEQUE_TARGET_AVX2 std::size_t _avx2_count(const T* data, std::size_t count, T value)
+{
+	auto broadcast = _avx2_broadcast(value);
+	std::size_t result = 0;
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		result += __builtin_popcount(_avx2_equal_mask(data + i, broadcast));
+	return result + _scalar_count(data + i, count - i, value);
+}
+
+DEQUE_TARGET_AVX2 inline void _avx2_fill(int* data, std::size_t count, int value)
+{
+	__m256i broadcast = _mm256_set1_epi32(value);
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), broadcast);
+	_scalar_fill(data + i, count - i, value);
+}
+
+DEQUE_TARGET_AVX2 inline void _avx2_fill(float* data, std::size_t count, float value)
+{
+	__m256 broadcast = _mm256_set1_ps(value);
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(data + i, broadcast);
+	_scalar_fill(data + i, count - i, value);
+}
+
+DEQUE_TARGET_AVX2 inline void _avx2_transform(int* data, std::size_t count, int multiplier, int addend)
+{
+	__m256i factor = _mm256_set1_epi32(multiplier);
+	__m256i term = _mm256_set1_epi32(addend);
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i* slot = reinterpret_cast<__m256i*>(data + i);
+		_mm256_storeu_si256(slot, _mm256_add_epi32(_mm256_mullo_epi32(_mm256_loadu_si256(slot), factor), term));
+	}
+	_scalar_transform(data + i, count - i, multiplier, addend);
+}
+
+DEQUE_TARGET_AVX2 inline void _avx2_transform(float* data, std::size_t count, float multiplier, float addend)
+{
+	//no FMA, so that every level rounds exactly like the scalar loop
+	__m256 factor = _mm256_set1_ps(multiplier);
+	__m256 term = _mm256_set1_ps(addend);
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(data + i, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(data + i), factor), term));
+	_scalar_transform(data + i, count - i, multiplier, addend);
+}
+
+#define DEQUE_SIMD_DISPATCH(level, kernel, scalar, ...) \
+	switch (level) \
+	{ \
+	case SimdLevel::Avx2: \
+		return _avx2_##kernel(__VA_ARGS__); \
+	case SimdLevel::Sse2: \
+		return _sse2_##kernel(__VA_ARGS__); \
+	default: \
+		return scalar; \
+	}
+
+#else
+
+#define DEQUE_SIMD_DISPATCH(level, kernel, scalar, ...) \
+	(void) level; \
+	return scalar;
+
+#endif
+
+// ==================== KERNELS =======================
+
+inline long long _simd_kernels<int>::sum(const int* data, std::size_t count, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, sum, _scalar_sum<long long>(data, count), data, count)
+}
+
+inline int _simd_kernels<int>::min(const int* data, std::size_t count, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, min, _scalar_min(data + 1, count - 1, data[0]), data, count)
+}
+
+inline int _simd_kernels<int>::max(const int* data, std::size_t count, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, max, _scalar_max(data + 1, count - 1, data[0]), data, count)
+}
+
+inline std::size_t _simd_kernels<int>::find(const int* data, std::size_t count, int value, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, find, _scalar_find(data, count, value), data, count, value)
+}
+
+inline std::size_t _simd_kernels<int>::count(const int* data, std::size_t count, int value, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, count, _scalar_count(data, count, value), data, count, value)
+}
+
+inline void _simd_kernels<int>::fill(int* data, std::size_t count, int value, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, fill, _scalar_fill(data, count, value), data, count, value)
+}
+
+inline void _simd_kernels<int>::transform(int* data, std::size_t count, int multiplier, int addend,
+	SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, transform, _scalar_transform(data, count, multiplier, addend),
+		data, count, multiplier, addend)
+}
+
+inline double _simd_kernels<float>::sum(const float* data, std::size_t count, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, sum, _scalar_sum<double>(data, count), data, count)
+}
+
+inline float _simd_kernels<float>::min(const float* data, std::size_t count, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, min, _scalar_min(data + 1, count - 1, data[0]), data, count)
+}
+
+inline float _simd_kernels<float>::max(const float* data, std::size_t count, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, max, _scalar_max(data + 1, count - 1, data[0]), data, count)
+}
+
+inline std::size_t _simd_kernels<float>::find(const float* data, std::size_t count, float value,
+	SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, find, _scalar_find(data, count, value), data, count, value)
+}
+
+inline std::size_t _simd_kernels<float>::count(const float* data, std::size_t count, float value,
+	SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, count, _scalar_count(data, count, value), data, count, value)
+}
+
+inline void _simd_kernels<float>::fill(float* data, std::size_t count, float value, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, fill, _scalar_fill(data, count, value), data, count, value)
+}
+
+inline void _simd_kernels<float>::transform(float* data, std::size_t count, float multiplier,
+	float addend, SimdLevel level)
+{
+	DEQUE_SIMD_DISPATCH(level, transform, _scalar_transform(data, count, multiplier, addend),
+		data, count, multiplier, addend)
+}
+
+#undef DEQUE_SIMD_DISPATCH
+
+// ==================== RANGES =======================
+
+template<typename TValue>
+typename _simd_kernels_for<TValue>::sum_type simd_sum(_ring_iterator<TValue> first,
+	_ring_iterator<TValue> last)
+{
+	SimdLevel level = simd_level();
+	typename _simd_kernels_for<TValue>::sum_type result = 0;
+	for_each_segment(first, last, [&result, level](TValue* data, std::ptrdiff_t count)
+	{
+		result += _simd_kernels_for<TValue>::sum(data, count, level);
+	});
+	return result;
+}
+
+template<typename TValue>
+typename std::remove_const<TValue>::type simd_min(_ring_iterator<TValue> first,
+	_ring_iterator<TValue> last)
+{
+	SimdLevel level = simd_level();
+	typename std::remove_const<TValue>::type result = *first;
+	for_each_segment(first, last, [&result, level](TValue* data, std::ptrdiff_t count)
+	{
+		typename std::remove_const<TValue>::type segment =
+			_simd_kernels_for<TValue>::min(data, count, level);
+		result = segment < result ? segment : result;
+	});
+	return result;
+}
+
+template<typename TValue>
+typename std::remove_const<TValue>::type simd_max(_ring_iterator<TValue> first,
+	_ring_iterator<TValue> last)
+{
+	SimdLevel level = simd_level();
+	typename std::remove_const<TValue>::type result = *first;
+	for_each_segment(first, last, [&result, level](TValue* data, std::ptrdiff_t count)
+	{
+		typename std::remove_const<TValue>::type segment =
+			_simd_kernels_for<TValue>::max(data, count, level);
+		result = result < segment ? segment : result;
+	});
+	return result;
+}
+
+template<typename TValue>
+_ring_iterator<TValue> simd_find(_ring_iterator<TValue> first, _ring_iterator<TValue> last,
+	typename std::remove_const<TValue>::type value)
+{
+	SimdLevel level = simd_level();
+	while (first != last)
+	{
+		typename _ring_iterator<TValue>::difference_type count =
+			std::min(last - first, first.segment_size());
+		std::size_t found = _simd_kernels_for<TValue>::find(first.operator->(), count, value, level);
+		if (found != std::size_t(count))
+			return first + found;
+		first += count;
+	}
+	return last;
+}
+
+template<typename TValue>
+std::ptrdiff_t simd_count(_ring_iterator<TValue> first, _ring_iterator<TValue> last,
+	typename std::remove_const<TValue>::type value)
+{
+	SimdLevel level = simd_level();
+	std::ptrdiff_t result = 0;
+	for_each_segment(first, last, [&result, value, level](TValue* data, std::ptrdiff_t count)
+	{
+		result += _simd_kernels_for<TValue>::count(data, count, value, level);
+	});
+	return result;
+}
+
+template<typename TValue>
+void simd_fill(_ring_iterator<TValue> first, _ring_iterator<TValue> last, TValue value)
+{
+	SimdLevel level = simd_level();
+	for_each_segment(first, last, [value, level](TValue* data, std::ptrdiff_t count)
+	{
+		_simd_kernels<TValue>::fill(data, count, value, level);
+	});
+}
+
+template<typename TValue>
+void simd_transform(_ring_iterator<TValue> first, _ring_iterator<TValue> last,
+	TValue multiplier, TValue addend)
+{
+	SimdLevel level = simd_level();
+	for_each_segment(first, last, [multiplier, addend, level](TValue* data, std::ptrdiff_t count)
+	{
+		_simd_kernels<TValue>::transform(data, count, multiplier, addend, level);
+	});
+}
@@ -0,0 +1,577 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "deque.hpp"
+#include "testing.hpp"
+#include "benchmark.hpp"
+
+
+//differential fuzzer: an arbitrary byte stream is decoded into operations,
+//which run on several Deque configurations and on a std::deque oracle, and
+//the two are compared after every step. built with -DDEQUE_LIBFUZZER it is a
+//libFuzzer target, otherwise main replays files, generates random inputs or
+//checks the throughput against a stored baseline.
+
+//reads the input a byte at a time, and yields zeros once it runs out
+class ByteStream
+{
+public:
+	ByteStream(const std::uint8_t* data, std::size_t size)
+		: _data(data), _size(size), _position(0)
+	{
+
+	}
+
+	bool done() const
+	{
+		return _position >= _size;
+	}
+
+	std::uint8_t byte()
+	{
+		return done() ? 0 : _data[_position++];
+	}
+
+	int value()
+	{
+		int high = byte();
+		return int(std::int16_t((high << 8) | byte()));
+	}
+
+	//a number below limit, from two bytes so that positions in large deques are reachable
+	std::size_t below(std::size_t limit)
+	{
+		std::size_t high = byte();
+		std::size_t raw = (high << 8) | byte();
+		return limit == 0 ? 0 : raw % limit;
+	}
+
+private:
+	const std::uint8_t* _data;
+	std::size_t _size;
+	std::size_t _position;
+};
+
+template<typename T>
+T MakeValue(int);
+
+template<>
+int MakeValue<int>(int value)
+{
+	return value;
+}
+
+//long enough to live on the heap, so that the sanitizers see every lost or doubled element
+template<>
+std::string MakeValue<std::string>(int value)
+{
+	return std::string(20, char('a' + (value & 7))) + std::to_string(value);
+}
+
+void Fail(const char* what, std::size_t step, std::size_t size)
+{
+	std::cerr << "Mismatch in " << what << " after operation " << step
+		<< " at size " << size << std::endl;
+	std::abort();
+}
+
+template<typename TDeque, typename T>
+void Check(const TDeque& deq, const std::deque<T>& oracle, std::size_t step)
+{
+	if (deq.size() != oracle.size() || deq.empty() != oracle.empty() || deq.capacity() < deq.size())
+		Fail("size", step, oracle.size());
+	if (!std::equal(deq.begin(), deq.end(), oracle.begin(), oracle.end()))
+		Fail("iteration", step, oracle.size());
+	for (std::size_t i = 0; i < oracle.size(); ++i)
+		if (deq[i] != oracle[i])
+			Fail("indexing", step, oracle.size());
+
+	auto spans = deq.as_spans();
+	if (spans.first.size + spans.second.size != deq.size())
+		Fail("spans", step, oracle.size());
+}
+
+//a string whose copies and moves throw once an armed countdown runs out. the
+//move is not noexcept, so growth has to copy, and a push that fails part way
+//through the relocation must leave the deque as it was
+class FragileString
+{
+public:
+	struct Failure
+	{
+
+	};
+
+	FragileString(const std::string& value)
+		: _value(value)
+	{
+
+	}
+
+	FragileString(const FragileString& other)
+		: _value((_tick(), other._value))
+	{
+
+	}
+
+	FragileString(FragileString&& other)
+		: _value((_tick(), std::move(other._value)))
+	{
+
+	}
+
+	FragileString& operator=(const FragileString&) = default;
+	FragileString& operator=(FragileString&&) = default;
+
+	bool operator==(const FragileString& other) const
+	{
+		return _value == other._value;
+	}
+
+	bool operator!=(const FragileString& other) const
+	{
+		return _value != other._value;
+	}
+
+	//-1 disarms
+	static int countdown;
+
+private:
+	static void _tick()
+	{
+		if (countdown >= 0 && countdown-- == 0)
+			throw Failure();
+	}
+
+	std::string _value;
+};
+
+int FragileString::countdown = -1;
+
+template<>
+FragileString MakeValue<FragileString>(int value)
+{
+	return FragileString(MakeValue<std::string>(value));
+}
+
+//pushes of FragileString read one more byte, which may arm a failure inside them
+template<typename T>
+void ArmFailure(ByteStream&, T*)
+{
+
+}
+
+void ArmFailure(ByteStream& in, FragileString*)
+{
+	int armed = in.byte();
+	FragileString::countdown = (armed & 1) == 0 ? -1 : armed >> 1;
+}
+
+//a batch for Deque::apply, replayed on the oracle only if every operation in it is valid
+template<typename TDeque, typename T>
+void FuzzApply(TDeque& deq, std::deque<T>& oracle, ByteStream& in, std::size_t step)
+{
+	std::vector<DequeOp<T>> batch;
+	std::deque<T> expected(oracle);
+	bool valid = true;
+	for (std::size_t count = in.byte() % 16; count > 0; --count)
+	{
+		DequeOp<T> op {DequeOpType(in.byte() % 5), in.byte(), MakeValue<T>(in.value())};
+		batch.push_back(op);
+		if (!valid)
+			continue;
+		switch (op.type)
+		{
+			case DequeOpType::PushBack: expected.push_back(op.value); break;
+			case DequeOpType::PushFront: expected.push_front(op.value); break;
+			case DequeOpType::PopBack: valid = !expected.empty(); if (valid) expected.pop_back(); break;
+			case DequeOpType::PopFront: valid = !expected.empty(); if (valid) expected.pop_front(); break;
+			case DequeOpType::IndexSet: valid = op.index < expected.size(); if (valid) expected[op.index] = op.value; break;
+		}
+	}
+
+	try
+	{
+		deq.apply(batch);
+		if (!valid)
+			Fail("apply accepting a bad batch", step, oracle.size());
+		oracle.swap(expected);
+	}
+	catch (const std::out_of_range&)
+	{
+		if (valid)
+			Fail("apply rejecting a good batch", step, oracle.size());
+	}
+}
+
+template<typename TDeque>
+void Run(const std::uint8_t* data, std::size_t size)
+{
+	using T = typename TDeque::value_type;
+	ByteStream in(data, size);
+	TDeque deq;
+	std::deque<T> oracle;
+
+	for (std::size_t step = 0; !in.done(); ++step)
+	{
+		int opcode = in.byte() % 16;
+		switch (opcode)
+		{
+			case 0:
+			case 1:
+			{
+				T value = MakeValue<T>(in.value());
+				bool back = opcode == 0;
+				ArmFailure(in, static_cast<T*>(nullptr));
+				try
+				{
+					if (back)
+						deq.push_back(value);
+					else
+						deq.push_front(value);
+				}
+				catch (const FragileString::Failure&)
+				{
+					//the strong guarantee: the oracle is left alone and the check
+					//below compares the deque against the contents before the push
+					FragileString::countdown = -1;
+					break;
+				}
+				FragileString::countdown = -1;
+				if (back)
+					oracle.push_back(value);
+				else
+					oracle.push_front(value);
+				break;
+			}
+			case 2:
+				if (oracle.empty()) break;
+				deq.pop_back();
+				oracle.pop_back();
+				break;
+			case 3:
+				if (oracle.empty()) break;
+				deq.pop_front();
+				oracle.pop_front();
+				break;
+			case 4:
+			{
+				if (oracle.empty()) break;
+				std::size_t index = in.below(oracle.size());
+				T value = MakeValue<T>(in.value());
+				deq[index] = value;
+				oracle[index] = value;
+				break;
+			}
+			//bursts walk the size across several resize boundaries at once
+			case 5:
+			case 6:
+			{
+				bool back = (in.byte() & 1) == 0;
+				//the count is read before the value, as a constructor's arguments are unordered
+				std::size_t count = in.byte() % 64;
+				std::vector<T> values(count, MakeValue<T>(in.value()));
+				if (back)
+				{
+					deq.append(values.begin(), values.end());
+					oracle.insert(oracle.end(), values.begin(), values.end());
+				}
+				else
+				{
+					deq.prepend(values.begin(), values.end());
+					oracle.insert(oracle.begin(), values.begin(), values.end());
+				}
+				break;
+			}
+			//and drains land on the shrink threshold from both sides
+			case 7:
+			{
+				std::size_t count = in.below(oracle.size() + 1);
+				deq.pop_back_n(count);
+				oracle.erase(oracle.end() - count, oracle.end());
+				break;
+			}
+			case 8:
+			{
+				std::size_t count = in.below(oracle.size() + 1);
+				deq.pop_front_n(count);
+				oracle.erase(oracle.begin(), oracle.begin() + count);
+				break;
+			}
+			case 9:
+			{
+				std::size_t position = in.below(oracle.size() + 1);
+				std::size_t count = in.byte() % 16;
+				std::vector<T> values(count, MakeValue<T>(in.value()));
+				deq.insert(deq.cbegin() + position, values.begin(), values.end());
+				//libstdc++ up to at least 12 moves the front half of a std::deque
+				//onto itself for an empty range, leaving moved-from elements
+				if (!values.empty())
+					oracle.insert(oracle.begin() + position, values.begin(), values.end());
+				break;
+			}
+			case 10:
+			{
+				std::size_t position = in.below(oracle.size() + 1);
+				std::size_t count = std::min<std::size_t>(in.byte() % 16, oracle.size() - position);
+				deq.erase(deq.cbegin() + position, deq.cbegin() + position + count);
+				oracle.erase(oracle.begin() + position, oracle.begin() + position + count);
+				break;
+			}
+			case 11:
+				deq.shrink_to_fit();
+				break;
+			case 12:
+				deq.reserve(oracle.size() + in.byte());
+				break;
+			case 13:
+				if (in.byte() % 4 != 0) break;
+				deq.clear();
+				oracle.clear();
+				break;
+			case 14:
+			{
+				TDeque copy(deq);
+				Check(copy, oracle, step);
+				deq = std::move(copy);
+				break;
+			}
+			case 15:
+				FuzzApply(deq, oracle, in, step);
+				break;
+		}
+		Check(deq, oracle, step);
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+	Run<Deque<int>>(data, size);
+	Run<Deque<int, PowerOfTwoGrowthPolicy>>(data, size);
+	Run<SmallDeque<int, 4>>(data, size);
+	Run<Deque<std::string>>(data, size);
+	Run<SmallDeque<std::string, 3, NoShrinkGrowthPolicy>>(data, size);
+	Run<Deque<FragileString>>(data, size);
+	return 0;
+}
+
+#ifndef DEQUE_LIBFUZZER
+
+const std::size_t PERF_OPS = 1 << 20;
+const int PERF_RUNS = 7;
+const int PERF_RETRIES = 2;
+
+void Replay(Deque<int>& deq, const TestData& testData)
+{
+	for (const Operation& op : testData)
+	{
+		switch (op.type)
+		{
+			case PushBack: deq.push_back(op.param2); break;
+			case PushFront: deq.push_front(op.param2); break;
+			case PopBack: deq.pop_back(); break;
+			case PopFront: deq.pop_front(); break;
+			case IndexSet: deq[op.param1] = op.param2; break;
+		}
+	}
+}
+
+//the best of several runs, which is the least noisy figure on a shared machine
+double WorkloadOpsPerSec(WorkloadShape shape)
+{
+	std::default_random_engine engine(42);
+	TestData testData;
+	GenerateWorkload(testData, shape, PERF_OPS, 10000, engine);
+
+	long long best = 0;
+	std::size_t sizes = 0;
+	for (int run = 0; run < PERF_RUNS; ++run)
+	{
+		bench_clock_t::time_point start(bench_clock_t::now());
+		Deque<int> deq;
+		Replay(deq, testData);
+		sizes += deq.size();
+		long long elapsed = ElapsedNs(start, bench_clock_t::now());
+		if (run == 0 || elapsed < best) best = elapsed;
+	}
+	if (sizes == 1) std::cout << sizes; //keeps the work alive
+	return testData.size()*1e9/best;
+}
+
+//random reads through operator[] on a wrapped ring. the ring and the indices
+//are kept small enough for the cache, so that the figure is the cost of the
+//index arithmetic and not of memory, which varies from run to run
+double IndexingOpsPerSec()
+{
+	Deque<int> deq;
+	for (int i = 0; i < 1 << 11; ++i)
+	{
+		deq.push_back(i);
+		deq.push_front(-i);
+	}
+	std::default_random_engine engine(42);
+	std::uniform_int_distribution<std::size_t> index(0, deq.size() - 1);
+	std::vector<std::size_t> indices(1 << 12);
+	for (std::size_t& i : indices)
+		i = index(engine);
+
+	long long best = 0;
+	long long checksum = 0;
+	for (int run = 0; run < PERF_RUNS; ++run)
+	{
+		bench_clock_t::time_point start(bench_clock_t::now());
+		for (std::size_t pass = 0; pass < PERF_OPS/indices.size(); ++pass)
+			for (std::size_t i : indices)
+				checksum += deq[i];
+		long long elapsed = ElapsedNs(start, bench_clock_t::now());
+		if (run == 0 || elapsed < best) best = elapsed;
+	}
+	if (checksum == 1) std::cout << checksum; //keeps the work alive
+	return PERF_OPS*1e9/best;
+}
+
+//baseline files hold one "name ops_per_sec" pair per line
+std::map<std::string, double> ReadBaseline(const char* path)
+{
+	std::map<std::string, double> result;
+	std::ifstream in(path);
+	std::string name;
+	double opsPerSec;
+	while (in >> name >> opsPerSec)
+		result[name] = opsPerSec;
+	return result;
+}
+
+double OpsPerSec(const std::string& name)
+{
+	for (WorkloadShape shape : ALL_WORKLOADS)
+		if (name == WorkloadName(shape))
+			return WorkloadOpsPerSec(shape);
+	return IndexingOpsPerSec();
+}
+
+int CheckPerformance(const char* baselinePath, bool record, double tolerance)
+{
+	std::vector<std::string> names;
+	for (WorkloadShape shape : ALL_WORKLOADS)
+		names.push_back(WorkloadName(shape));
+	names.push_back("indexing");
+
+	std::map<std::string, double> measured;
+	for (const std::string& name : names)
+		measured[name] = OpsPerSec(name);
+
+	if (record)
+	{
+		std::ofstream out(baselinePath);
+		for (const auto& entry : measured)
+			out << entry.first << " " << (long long) entry.second << std::endl;
+		std::cout << "Recorded the baseline in " << baselinePath << std::endl;
+		return 0;
+	}
+
+	std::map<std::string, double> baseline = ReadBaseline(baselinePath);
+	int regressions = 0;
+	for (auto& entry : measured)
+	{
+		auto expected = baseline.find(entry.first);
+		if (expected == baseline.end())
+		{
+			std::cout << entry.first << ": " << (long long) entry.second << " ops/s (no baseline)" << std::endl;
+			continue;
+		}
+		//a shared machine has slow stretches longer than all the runs of one
+		//measurement, so a figure below the baseline is taken again before it counts
+		for (int retry = 0; retry < PERF_RETRIES && entry.second < (1 - tolerance)*expected->second; ++retry)
+			entry.second = std::max(entry.second, OpsPerSec(entry.first));
+		double ratio = entry.second/expected->second;
+		bool regressed = ratio < 1 - tolerance;
+		regressions += regressed;
+		std::cout << entry.first << ": " << (long long) entry.second << " ops/s, "
+			<< ratio*100 << "% of the baseline" << (regressed ? " REGRESSED" : "") << std::endl;
+	}
+	return regressions == 0 ? 0 : 1;
+}
+
+int FuzzRandom(std::size_t inputs, unsigned seed)
+{
+	std::default_random_engine engine(seed);
+	std::uniform_int_distribution<std::size_t> length(0, 4096);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::vector<std::uint8_t> data;
+	for (std::size_t i = 0; i < inputs; ++i)
+	{
+		data.resize(length(engine));
+		for (std::uint8_t& value : data)
+			value = std::uint8_t(byte(engine));
+		LLVMFuzzerTestOneInput(data.data(), data.size());
+	}
+	std::cout << "Ran " << inputs << " random inputs from seed " << seed << std::endl;
+	return 0;
+}
+
+int FuzzFile(const char* path)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+	{
+		std::cerr << "Can not read " << path << std::endl;
+		return 1;
+	}
+	std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	LLVMFuzzerTestOneInput(data.data(), data.size());
+	std::cout << "Replayed " << path << std::endl;
+	return 0;
+}
+
+//fuzztest --random N [--seed S]     fuzzes N random inputs (the default, 1000 of them)
+//fuzztest --perf FILE [--record] [--tolerance T]
+//                                   compares ops/s against the baseline in FILE, failing below 1 - T of it
+//fuzztest FILE...                   replays saved inputs, such as libFuzzer crashes
+int main(int argc, char** argv)
+{
+	std::size_t inputs = 1000;
+	unsigned seed = 0;
+	const char* baselinePath = nullptr;
+	bool record = false;
+	double tolerance = 0.15;
+	std::vector<const char*> files;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--random") == 0 && i + 1 < argc)
+			inputs = std::strtoull(argv[++i], nullptr, 10);
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = unsigned(std::strtoul(argv[++i], nullptr, 10));
+		else if (std::strcmp(argv[i], "--perf") == 0 && i + 1 < argc)
+			baselinePath = argv[++i];
+		else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+			tolerance = std::strtod(argv[++i], nullptr);
+		else if (std::strcmp(argv[i], "--record") == 0)
+			record = true;
+		else
+			files.push_back(argv[i]);
+	}
+
+	if (baselinePath != nullptr)
+		return CheckPerformance(baselinePath, record, tolerance);
+
+	int result = 0;
+	for (const char* path : files)
+		result |= FuzzFile(path);
+	if (files.empty())
+		result = FuzzRandom(inputs, seed);
+	return result;
+}
+
+#endif
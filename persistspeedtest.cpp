@@ -0,0 +1,99 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include "deque.hpp"
+#include "deque_persistence.hpp"
+#include "benchmark.hpp"
+
+
+const std::size_t COUNT = 10000000;
+const char* const STREAM_PATH = "persist_speedtest.bin";
+const char* const MAPPED_PATH = "persist_speedtest.map";
+
+double ElapsedMs(bench_clock_t::time_point start)
+{
+	return ElapsedNs(start, bench_clock_t::now())/1e6;
+}
+
+long long Checksum(const Deque<int>& deq)
+{
+	long long result = 0;
+	for (int value : deq)
+		result += value;
+	return result;
+}
+
+int main()
+{
+	Deque<int> deq;
+	//filled from both ends, so that the ring wraps around
+	for (std::size_t i = 0; i < COUNT/2; ++i)
+	{
+		deq.push_back(int(i));
+		deq.push_front(int(i));
+	}
+	std::cout << "Saving and restoring " << COUNT << " ints (checksum " << Checksum(deq) << ")..."
+		<< std::endl;
+
+	{
+		bench_clock_t::time_point start(bench_clock_t::now());
+		std::ofstream out(STREAM_PATH, std::ios::binary);
+		for (int value : deq)
+			out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		out.close();
+		std::cout << "Element by element save: " << ElapsedMs(start) << "ms" << std::endl;
+
+		start = bench_clock_t::now();
+		std::ifstream in(STREAM_PATH, std::ios::binary);
+		Deque<int> restored;
+		int value;
+		while (in.read(reinterpret_cast<char*>(&value), sizeof(value)))
+			restored.push_back(value);
+		std::cout << "Element by element restore: " << ElapsedMs(start) << "ms (checksum "
+			<< Checksum(restored) << ")" << std::endl;
+	}
+
+	{
+		bench_clock_t::time_point start(bench_clock_t::now());
+		std::ofstream out(STREAM_PATH, std::ios::binary);
+		save_deque(out, deq);
+		out.close();
+		std::cout << "save_deque: " << ElapsedMs(start) << "ms" << std::endl;
+
+		start = bench_clock_t::now();
+		std::ifstream in(STREAM_PATH, std::ios::binary);
+		Deque<int> restored;
+		load_deque(in, restored);
+		std::cout << "load_deque: " << ElapsedMs(start) << "ms (checksum "
+			<< Checksum(restored) << ")" << std::endl;
+	}
+	std::remove(STREAM_PATH);
+
+	{
+		std::remove(MAPPED_PATH);
+		bench_clock_t::time_point start(bench_clock_t::now());
+		{
+			MappedDeque<int> mapped(MAPPED_PATH);
+			for (std::size_t i = 0; i < COUNT/2; ++i)
+			{
+				mapped.push_back(int(i));
+				mapped.push_front(int(i));
+			}
+		}
+		std::cout << "MappedDeque fill: " << ElapsedMs(start) << "ms" << std::endl;
+
+		start = bench_clock_t::now();
+		MappedDeque<int> mapped(MAPPED_PATH);
+		std::cout << "MappedDeque reopen: " << ElapsedMs(start) << "ms (" << mapped.size()
+			<< " elements)" << std::endl;
+
+		start = bench_clock_t::now();
+		long long checksum = 0;
+		for (std::size_t i = 0; i < mapped.size(); ++i)
+			checksum += mapped[i];
+		std::cout << "MappedDeque first scan: " << ElapsedMs(start) << "ms (checksum "
+			<< checksum << ")" << std::endl;
+	}
+	std::remove(MAPPED_PATH);
+	return 0;
+}
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <string>
+#include "deque.hpp"
+#include "deque_algorithm.hpp"
+#include "deque_simd.hpp"
+
+
+const std::size_t COUNT = 1000000;
+const std::size_t REPEAT = 100;
+
+//runs the scan REPEAT times and prints the time per element
+template<typename TScan>
+void Report(const std::string& name, TScan scan)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	long long checksum = 0;
+	clock_t::time_point start(clock_t::now());
+	for (std::size_t i = 0; i < REPEAT; ++i)
+		checksum += scan();
+	long long elapsed = std::chrono::duration_cast<ns_t>(clock_t::now() - start).count();
+
+	std::cout << name << ": " << (double) elapsed/(COUNT*REPEAT) << "ns per element"
+		<< " (checksum " << checksum << ")" << std::endl;
+}
+
+//reports the scan once for every kernel the CPU supports
+template<typename TScan>
+void ReportSimd(const std::string& name, TScan scan)
+{
+	SimdLevel supported = simd_supported_level();
+	for (int level = 0; level <= int(supported); ++level)
+	{
+		set_simd_level(SimdLevel(level));
+		Report(name + " " + simd_level_name(SimdLevel(level)), scan);
+	}
+	set_simd_level(supported);
+}
+
+int main()
+{
+	std::vector<int> vec;
+	std::deque<int> stdDeque;
+	Deque<int> deq;
+
+	//fill from both ends so that the ring wraps around
+	for (std::size_t i = 0; i < COUNT/2; ++i)
+	{
+		vec.push_back(i);
+		stdDeque.push_back(i);
+		deq.push_back(i);
+		stdDeque.push_front(i);
+		deq.push_front(i);
+	}
+	vec.insert(vec.begin(), stdDeque.begin(), stdDeque.begin() + COUNT/2);
+
+	std::cout << "Accumulating " << COUNT << " ints..." << std::endl;
+	Report("std::vector", [&]() { return std::accumulate(vec.begin(), vec.end(), 0ll); });
+	Report("std::deque", [&]() { return std::accumulate(stdDeque.begin(), stdDeque.end(), 0ll); });
+	Report("Deque operator[]", [&]()
+	{
+		long long sum = 0;
+		for (std::size_t i = 0; i < deq.size(); ++i) sum += deq[i];
+		return sum;
+	});
+	Report("Deque iterators", [&]() { return std::accumulate(deq.begin(), deq.end(), 0ll); });
+	Report("Deque segmented", [&]() { return segmented_accumulate(deq.begin(), deq.end(), 0ll); });
+	ReportSimd("Deque simd", [&]() { return simd_sum(deq.cbegin(), deq.cend()); });
+
+	std::cout << std::endl << "Finding a missing value among " << COUNT << " ints..." << std::endl;
+	Report("std::vector", [&]() { return std::find(vec.begin(), vec.end(), COUNT) - vec.begin(); });
+	Report("std::deque", [&]()
+	{
+		return std::find(stdDeque.begin(), stdDeque.end(), COUNT) - stdDeque.begin();
+	});
+	Report("Deque iterators", [&]() { return std::find(deq.begin(), deq.end(), COUNT) - deq.begin(); });
+	Report("Deque segmented", [&]()
+	{
+		return segmented_find(deq.begin(), deq.end(), COUNT) - deq.begin();
+	});
+	ReportSimd("Deque simd", [&]() { return simd_find(deq.begin(), deq.end(), COUNT) - deq.begin(); });
+
+	std::cout << std::endl << "Counting a value among " << COUNT << " ints..." << std::endl;
+	Report("std::vector", [&]() { return std::count(vec.begin(), vec.end(), 7); });
+	Report("Deque iterators", [&]() { return std::count(deq.begin(), deq.end(), 7); });
+	ReportSimd("Deque simd", [&]() { return simd_count(deq.begin(), deq.end(), 7); });
+
+	std::cout << std::endl << "Minimum of " << COUNT << " ints..." << std::endl;
+	Report("std::vector", [&]() { return *std::min_element(vec.begin(), vec.end()); });
+	Report("Deque iterators", [&]() { return *std::min_element(deq.begin(), deq.end()); });
+	ReportSimd("Deque simd", [&]() { return simd_min(deq.begin(), deq.end()); });
+
+	//x*-1 + 0 is undone by the next repeat, so the checksum stays put
+	std::cout << std::endl << "Transforming " << COUNT << " ints in place..." << std::endl;
+	Report("std::vector", [&]()
+	{
+		std::transform(vec.begin(), vec.end(), vec.begin(), [](int value) { return value*-1 + 0; });
+		return vec[7];
+	});
+	Report("Deque iterators", [&]()
+	{
+		std::transform(deq.begin(), deq.end(), deq.begin(), [](int value) { return value*-1 + 0; });
+		return deq[7];
+	});
+	ReportSimd("Deque simd", [&]() { simd_transform(deq.begin(), deq.end(), -1, 0); return deq[7]; });
+
+	Deque<float> floats;
+	for (int value : deq)
+		floats.push_back(float(value));
+	std::cout << std::endl << "Accumulating " << COUNT << " floats..." << std::endl;
+	Report("Deque iterators", [&]() { return (long long) std::accumulate(floats.begin(), floats.end(), 0.0); });
+	ReportSimd("Deque simd", [&]() { return (long long) simd_sum(floats.begin(), floats.end()); });
+
+	std::vector<int> out(COUNT);
+	std::cout << std::endl << "Copying " << COUNT << " ints out..." << std::endl;
+	Report("std::vector", [&]() { std::copy(vec.begin(), vec.end(), out.begin()); return out[7]; });
+	Report("std::deque", [&]()
+	{
+		std::copy(stdDeque.begin(), stdDeque.end(), out.begin());
+		return out[7];
+	});
+	Report("Deque iterators", [&]() { std::copy(deq.begin(), deq.end(), out.begin()); return out[7]; });
+	Report("Deque segmented", [&]()
+	{
+		segmented_copy(deq.begin(), deq.end(), out.begin());
+		return out[7];
+	});
+	return 0;
+}
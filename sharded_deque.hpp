@@ -0,0 +1,89 @@
+#ifndef SHARDED_DEQUE_HPP
+#define SHARDED_DEQUE_HPP
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include "deque.hpp"
+
+
+enum class ShardOrder
+{
+	//every pop takes the oldest element of its shard
+	Fifo,
+	//a thread pops the newest element of its own shard and the oldest
+	//element of anyone else's, like WorkStealingDeque
+	LocalLifo
+};
+
+//multi producer/multi consumer queue made of one mutex guarded Deque per
+//shard. each thread is given a home shard the first time it touches any
+//ShardedDeque, pushes go there and pops try there first, then steal from
+//the other shards in turn, so threads only meet on a lock when one of
+//them runs dry. the order is only relaxed FIFO: with ShardOrder::Fifo the
+//elements of one shard leave in the order they came, which keeps the
+//order of every single producer, but shards are drained independently.
+template<typename T>
+class ShardedDeque
+{
+public:
+	using size_type = std::size_t;
+	using value_type = T;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+
+	//0 shards means one per hardware thread
+	explicit ShardedDeque(size_type = 0, ShardOrder = ShardOrder::Fifo);
+
+	ShardedDeque(const ShardedDeque<T>&) = delete;
+	ShardedDeque<T>& operator=(const ShardedDeque<T>&) = delete;
+
+	//size and empty are exact only when no other thread is pushing or popping
+	bool empty() const;
+	size_type size() const;
+	size_type shard_count() const;
+	ShardOrder order() const;
+
+	void push(const_reference);
+	void push(value_type&&);
+	template<typename... TArgs>
+	void emplace(TArgs&&...);
+
+	//false only if every shard was seen empty
+	bool try_pop(reference);
+
+	//lock acquisitions that found the shard already locked, summed over shards
+	size_type contended_locks() const;
+
+	//the shard pushes from the calling thread land in
+	size_type home_shard() const;
+
+private:
+	struct _Shard
+	{
+		_Shard();
+
+		std::mutex mutex;
+		Deque<T> items;
+		//mirrors items.size() so that empty shards are skipped without locking
+		std::atomic<size_type> size;
+		std::atomic<size_type> contended;
+		char padding[64];
+	};
+
+	static std::unique_lock<std::mutex> _lock(_Shard&);
+	bool _try_pop(_Shard&, reference, bool newest);
+
+	static size_type _thread_slot();
+
+	std::vector<std::unique_ptr<_Shard>> _shards;
+	ShardOrder _order;
+};
+
+#include "sharded_deque.tpp"
+
+#endif //SHARDED_DEQUE_HPP
@@ -0,0 +1,150 @@
+#include "sharded_deque.hpp"
+
+template<typename T>
+ShardedDeque<T>::_Shard::_Shard()
+	: size(0), contended(0)
+{
+
+}
+
+template<typename T>
+ShardedDeque<T>::ShardedDeque(typename ShardedDeque<T>::size_type shards, ShardOrder order)
+	: _order(order)
+{
+	if (shards == 0)
+		shards = std::thread::hardware_concurrency();
+	if (shards == 0)
+		shards = 1;
+	for (size_type i = 0; i < shards; ++i)
+		_shards.emplace_back(new _Shard());
+}
+
+template<typename T>
+bool ShardedDeque<T>::empty() const
+{
+	return size() == 0;
+}
+
+template<typename T>
+typename ShardedDeque<T>::size_type ShardedDeque<T>::size() const
+{
+	size_type result = 0;
+	for (const auto& shard : _shards)
+		result += shard->size.load(std::memory_order_relaxed);
+	return result;
+}
+
+template<typename T>
+typename ShardedDeque<T>::size_type ShardedDeque<T>::shard_count() const
+{
+	return _shards.size();
+}
+
+template<typename T>
+ShardOrder ShardedDeque<T>::order() const
+{
+	return _order;
+}
+
+template<typename T>
+void ShardedDeque<T>::push(typename ShardedDeque<T>::const_reference value)
+{
+	emplace(value);
+}
+
+template<typename T>
+void ShardedDeque<T>::push(typename ShardedDeque<T>::value_type&& value)
+{
+	emplace(std::move(value));
+}
+
+template<typename T>
+template<typename... TArgs>
+void ShardedDeque<T>::emplace(TArgs&&... args)
+{
+	_Shard& shard = *_shards[home_shard()];
+	std::unique_lock<std::mutex> lock(_lock(shard));
+	shard.items.emplace_back(std::forward<TArgs>(args)...);
+	shard.size.store(shard.items.size(), std::memory_order_relaxed);
+}
+
+template<typename T>
+bool ShardedDeque<T>::try_pop(typename ShardedDeque<T>::reference value)
+{
+	size_type home = home_shard();
+	if (_try_pop(*_shards[home], value, _order == ShardOrder::LocalLifo))
+		return true;
+
+	//steal from the next shard over first, so that idle threads spread out
+	for (size_type i = 1; i < _shards.size(); ++i)
+	{
+		size_type victim = home + i;
+		if (victim >= _shards.size())
+			victim -= _shards.size();
+		if (_try_pop(*_shards[victim], value, false))
+			return true;
+	}
+	return false;
+}
+
+template<typename T>
+typename ShardedDeque<T>::size_type ShardedDeque<T>::contended_locks() const
+{
+	size_type result = 0;
+	for (const auto& shard : _shards)
+		result += shard->contended.load(std::memory_order_relaxed);
+	return result;
+}
+
+template<typename T>
+typename ShardedDeque<T>::size_type ShardedDeque<T>::home_shard() const
+{
+	size_type slot = _thread_slot();
+	return slot < _shards.size() ? slot : slot % _shards.size();
+}
+
+template<typename T>
+std::unique_lock<std::mutex> ShardedDeque<T>::_lock(typename ShardedDeque<T>::_Shard& shard)
+{
+	std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+	if (!lock.owns_lock())
+	{
+		shard.contended.fetch_add(1, std::memory_order_relaxed);
+		lock.lock();
+	}
+	return lock;
+}
+
+template<typename T>
+bool ShardedDeque<T>::_try_pop(typename ShardedDeque<T>::_Shard& shard,
+	typename ShardedDeque<T>::reference value, bool newest)
+{
+	if (shard.size.load(std::memory_order_relaxed) == 0)
+		return false;
+
+	std::unique_lock<std::mutex> lock(_lock(shard));
+	if (shard.items.empty())
+		return false;
+
+	if (newest)
+	{
+		value = std::move(shard.items.back());
+		shard.items.pop_back();
+	}
+	else
+	{
+		value = std::move(shard.items.front());
+		shard.items.pop_front();
+	}
+	shard.size.store(shard.items.size(), std::memory_order_relaxed);
+	return true;
+}
+
+template<typename T>
+typename ShardedDeque<T>::size_type ShardedDeque<T>::_thread_slot()
+{
+	//handed out in turn, so the first shard_count() threads get a shard each
+	static std::atomic<size_type> next(0);
+	static thread_local size_type slot = next.fetch_add(1, std::memory_order_relaxed);
+	return slot;
+}
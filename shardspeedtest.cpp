@@ -0,0 +1,155 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "deque.hpp"
+#include "sharded_deque.hpp"
+
+
+const std::size_t ITEMS = 1u << 21;
+const std::size_t BURST = 16;
+
+struct Result
+{
+	double ops_per_sec;
+	double contention;
+};
+
+//one Deque behind one mutex, counting contended locks the way ShardedDeque does
+class LockedDeque
+{
+public:
+	LockedDeque() : _contended(0) {}
+
+	void push(std::uint64_t value)
+	{
+		std::unique_lock<std::mutex> lock(_lock());
+		_items.push_back(value);
+	}
+
+	bool try_pop(std::uint64_t& value)
+	{
+		std::unique_lock<std::mutex> lock(_lock());
+		if (_items.empty())
+			return false;
+		value = _items.front();
+		_items.pop_front();
+		return true;
+	}
+
+	std::size_t contended_locks() const
+	{
+		return _contended.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::unique_lock<std::mutex> _lock()
+	{
+		std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
+		if (!lock.owns_lock())
+		{
+			_contended.fetch_add(1, std::memory_order_relaxed);
+			lock.lock();
+		}
+		return lock;
+	}
+
+	std::mutex _mutex;
+	Deque<std::uint64_t> _items;
+	std::atomic<std::size_t> _contended;
+};
+
+//every thread pushes its share of the items in bursts and pops a burst
+//after each one, until all items made it through the queue
+template<typename TQueue>
+Result Run(TQueue& queue, std::size_t threads)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	std::atomic<std::size_t> popped(0);
+	std::atomic<std::uint64_t> checksum(0);
+	std::atomic<std::size_t> attempts(0);
+
+	auto worker = [&](std::size_t id)
+	{
+		std::size_t share = ITEMS/threads;
+		std::uint64_t sum = 0;
+		std::size_t tries = 0;
+		std::uint64_t value;
+		for (std::size_t i = 0; i < share; i += BURST)
+		{
+			for (std::size_t j = i; j < i + BURST && j < share; ++j)
+				queue.push(id*share + j);
+			for (std::size_t j = 0; j < BURST; ++j, ++tries)
+			{
+				if (!queue.try_pop(value))
+					break;
+				sum += value;
+				++popped;
+			}
+		}
+		while (popped < share*threads)
+		{
+			++tries;
+			if (queue.try_pop(value))
+			{
+				sum += value;
+				++popped;
+			}
+			else
+				std::this_thread::yield();
+		}
+		checksum += sum;
+		attempts += tries;
+	};
+
+	clock_t::time_point start(clock_t::now());
+	std::vector<std::thread> pool;
+	for (std::size_t i = 1; i < threads; ++i)
+		pool.emplace_back(worker, i);
+	worker(0);
+	for (auto& thread : pool)
+		thread.join();
+	long long elapsed = std::chrono::duration_cast<ns_t>(clock_t::now() - start).count();
+
+	if (checksum == 0) std::cout << checksum; //keeps the work alive
+	std::size_t ops = popped + ITEMS/threads*threads;
+	Result result;
+	result.ops_per_sec = ops*1e9/elapsed;
+	result.contention = double(queue.contended_locks())/(ITEMS/threads*threads + attempts);
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	std::size_t cores = std::thread::hardware_concurrency();
+	if (cores == 0) cores = 1;
+	std::size_t limit = argc > 1 ? std::stoul(argv[1]) : cores;
+
+	std::cout << "Push/pop of " << ITEMS << " items in bursts of " << BURST
+		<< " on " << cores << " hardware threads..." << std::endl;
+	for (std::size_t threads = 1; threads <= limit; threads *= 2)
+	{
+		LockedDeque locked;
+		Result single = Run(locked, threads);
+		ShardedDeque<std::uint64_t> sharded(threads);
+		Result fifo = Run(sharded, threads);
+		ShardedDeque<std::uint64_t> lifo(threads, ShardOrder::LocalLifo);
+		Result local = Run(lifo, threads);
+
+		std::cout << threads << " threads: "
+			<< "mutex Deque " << (long long) single.ops_per_sec << " ops/s ("
+			<< single.contention*100 << "% contended), "
+			<< "ShardedDeque " << (long long) fifo.ops_per_sec << " ops/s ("
+			<< fifo.contention*100 << "% contended), "
+			<< "ShardedDeque LocalLifo " << (long long) local.ops_per_sec << " ops/s ("
+			<< local.contention*100 << "% contended)"
+			<< std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,124 @@
+#ifndef SHARED_DEQUE_HPP
+#define SHARED_DEQUE_HPP
+
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+#include "deque.hpp"
+#include "block_deque.hpp"
+
+
+//deque with structural sharing: elements live in fixed-size chunks held by
+//shared_ptr, and the table of chunks is itself shared. copying, or taking a
+//snapshot(), is O(1). the first change after that copies the table, which is
+//size()/ChunkSize pointers. every change after that copies at most the one chunk it touches,
+//and only while another copy still holds that chunk.
+//a copy may be read from another thread while the original keeps changing,
+//but one SharedDeque object must not be used by two threads at once
+template<typename T, std::size_t ChunkSize = _default_block_size<T>()>
+class SharedDeque
+{
+public:
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+
+	using value_type = T;
+	using reference = value_type&;
+	using pointer = value_type*;
+
+	using const_value_type = const T;
+	using const_reference = const value_type&;
+	using const_pointer = const value_type*;
+
+	//only const iteration: writing through an iterator would have to unshare on every dereference
+	using const_iterator = _iterator_base<const SharedDeque<T, ChunkSize>*>;
+
+	SharedDeque();
+	SharedDeque(const SharedDeque<T, ChunkSize>&) = default;
+	SharedDeque(SharedDeque<T, ChunkSize>&&) noexcept;
+
+	SharedDeque<T, ChunkSize>& operator=(const SharedDeque<T, ChunkSize>&) = default;
+	SharedDeque<T, ChunkSize>& operator=(SharedDeque<T, ChunkSize>&&) noexcept;
+
+	void swap(SharedDeque<T, ChunkSize>&) noexcept;
+
+	//an immutable view of the current contents, the same as a copy
+	SharedDeque<T, ChunkSize> snapshot() const;
+
+	bool empty() const;
+	size_type size() const;
+
+	void clear();
+
+	//the non-const versions unshare the chunk holding the element
+	reference operator[](difference_type);
+	const_reference operator[](difference_type) const;
+
+	void push_back(const_reference);
+	void push_back(value_type&&);
+	template<typename... TArgs>
+	reference emplace_back(TArgs&&...);
+	void pop_back();
+
+	void push_front(const_reference);
+	void push_front(value_type&&);
+	template<typename... TArgs>
+	reference emplace_front(TArgs&&...);
+	void pop_front();
+
+	reference back();
+	const_reference back() const;
+
+	reference front();
+	const_reference front() const;
+
+	const_iterator begin() const;
+	const_iterator cbegin() const;
+
+	const_iterator end() const;
+	const_iterator cend() const;
+
+private:
+	//slots [begin, end) of a chunk hold live objects
+	struct _Chunk
+	{
+		explicit _Chunk(size_type position);
+		_Chunk(const _Chunk&) = delete;
+		_Chunk& operator=(const _Chunk&) = delete;
+		~_Chunk();
+
+		T* data();
+		void trim(size_type, size_type);
+
+		size_type begin;
+		size_type end;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[ChunkSize];
+	};
+
+	using _chunk_ptr = std::shared_ptr<_Chunk>;
+	using _index_type = Deque<_chunk_ptr>;
+
+	_index_type& _unique_index();
+	_Chunk& _unique_chunk(size_type);
+	bool _owns_chunk(const _chunk_ptr&) const;
+	size_type _view_begin(size_type) const;
+	size_type _view_end(size_type) const;
+
+	//elements occupy positions [_offset, _offset + _size) counted from the
+	//first slot of the first chunk. the table is null while the deque is empty
+	std::shared_ptr<_index_type> _chunks;
+	size_type _offset;
+	size_type _size;
+
+	static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0,
+		"Chunk size must be a power of two");
+};
+
+template<typename T, std::size_t ChunkSize>
+void swap(SharedDeque<T, ChunkSize>&, SharedDeque<T, ChunkSize>&) noexcept;
+
+#include "shared_deque.tpp"
+
+#endif //SHARED_DEQUE_HPP
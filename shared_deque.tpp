@@ -0,0 +1,344 @@
+#include "shared_deque.hpp"
+
+template<typename T, std::size_t ChunkSize>
+SharedDeque<T, ChunkSize>::SharedDeque()
+	: _chunks(nullptr), _offset(0), _size(0)
+{
+
+}
+
+template<typename T, std::size_t ChunkSize>
+SharedDeque<T, ChunkSize>::SharedDeque(SharedDeque<T, ChunkSize>&& other) noexcept
+	: SharedDeque()
+{
+	swap(other);
+}
+
+template<typename T, std::size_t ChunkSize>
+SharedDeque<T, ChunkSize>& SharedDeque<T, ChunkSize>::operator=(SharedDeque<T, ChunkSize>&& other) noexcept
+{
+	SharedDeque<T, ChunkSize> tmp(std::move(other));
+	swap(tmp);
+	return *this;
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::swap(SharedDeque<T, ChunkSize>& other) noexcept
+{
+	std::swap(_chunks, other._chunks);
+	std::swap(_offset, other._offset);
+	std::swap(_size, other._size);
+}
+
+template<typename T, std::size_t ChunkSize>
+SharedDeque<T, ChunkSize> SharedDeque<T, ChunkSize>::snapshot() const
+{
+	return *this;
+}
+
+template<typename T, std::size_t ChunkSize>
+bool SharedDeque<T, ChunkSize>::empty() const
+{
+	return _size == 0;
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::size_type SharedDeque<T, ChunkSize>::size() const
+{
+	return _size;
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::clear()
+{
+	_chunks.reset();
+	_offset = 0;
+	_size = 0;
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::reference SharedDeque<T, ChunkSize>::operator[](
+	SharedDeque<T, ChunkSize>::difference_type index)
+{
+	size_type position = _offset + index;
+	return _unique_chunk(position/ChunkSize).data()[position % ChunkSize];
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::const_reference SharedDeque<T, ChunkSize>::operator[](
+	SharedDeque<T, ChunkSize>::difference_type index) const
+{
+	size_type position = _offset + index;
+	return (*_chunks)[position/ChunkSize]->data()[position % ChunkSize];
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::push_back(SharedDeque<T, ChunkSize>::const_reference value)
+{
+	emplace_back(value);
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::push_back(SharedDeque<T, ChunkSize>::value_type&& value)
+{
+	emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t ChunkSize>
+template<typename... TArgs>
+typename SharedDeque<T, ChunkSize>::reference SharedDeque<T, ChunkSize>::emplace_back(TArgs&&... args)
+{
+	size_type position = _offset + _size;
+	_index_type& index = _unique_index();
+	if (position/ChunkSize == index.size())
+	{
+		//the element goes into the new chunk before the chunk goes into the table,
+		//so that a throwing constructor leaves nothing behind
+		_chunk_ptr chunk = std::make_shared<_Chunk>(0);
+		T* slot = chunk->data();
+		::new (static_cast<void*>(slot)) T(std::forward<TArgs>(args)...);
+		++chunk->end;
+		index.push_back(std::move(chunk));
+		++_size;
+		return *slot;
+	}
+
+	_Chunk& chunk = _unique_chunk(position/ChunkSize);
+	T* slot = chunk.data() + position % ChunkSize;
+	::new (static_cast<void*>(slot)) T(std::forward<TArgs>(args)...);
+	++chunk.end;
+	++_size;
+	return *slot;
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::pop_back()
+{
+	size_type position = _offset + _size - 1;
+	_index_type& index = _unique_index();
+	//a chunk some snapshot still holds keeps the element, it just leaves this view
+	if (_owns_chunk(index[position/ChunkSize]))
+	{
+		_Chunk& chunk = _unique_chunk(position/ChunkSize);
+		chunk.trim(chunk.begin, chunk.end - 1);
+	}
+	--_size;
+	if (_size == 0)
+	{
+		clear();
+		return;
+	}
+	if (position % ChunkSize == 0)
+		index.pop_back();
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::push_front(SharedDeque<T, ChunkSize>::const_reference value)
+{
+	emplace_front(value);
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::push_front(SharedDeque<T, ChunkSize>::value_type&& value)
+{
+	emplace_front(std::move(value));
+}
+
+template<typename T, std::size_t ChunkSize>
+template<typename... TArgs>
+typename SharedDeque<T, ChunkSize>::reference SharedDeque<T, ChunkSize>::emplace_front(TArgs&&... args)
+{
+	_index_type& index = _unique_index();
+	if (_offset == 0)
+	{
+		_chunk_ptr chunk = std::make_shared<_Chunk>(ChunkSize);
+		T* slot = chunk->data() + ChunkSize - 1;
+		::new (static_cast<void*>(slot)) T(std::forward<TArgs>(args)...);
+		--chunk->begin;
+		index.push_front(std::move(chunk));
+		_offset = ChunkSize - 1;
+		++_size;
+		return *slot;
+	}
+
+	_Chunk& chunk = _unique_chunk(0);
+	T* slot = chunk.data() + _offset - 1;
+	::new (static_cast<void*>(slot)) T(std::forward<TArgs>(args)...);
+	--chunk.begin;
+	--_offset;
+	++_size;
+	return *slot;
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::pop_front()
+{
+	_index_type& index = _unique_index();
+	if (_owns_chunk(index[0]))
+	{
+		_Chunk& chunk = _unique_chunk(0);
+		chunk.trim(chunk.begin + 1, chunk.end);
+	}
+	--_size;
+	++_offset;
+	if (_size == 0)
+	{
+		clear();
+		return;
+	}
+	if (_offset == ChunkSize)
+	{
+		index.pop_front();
+		_offset = 0;
+	}
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::reference SharedDeque<T, ChunkSize>::back()
+{
+	return operator[](_size - 1);
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::const_reference SharedDeque<T, ChunkSize>::back() const
+{
+	return operator[](_size - 1);
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::reference SharedDeque<T, ChunkSize>::front()
+{
+	return operator[](0);
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::const_reference SharedDeque<T, ChunkSize>::front() const
+{
+	return operator[](0);
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::const_iterator SharedDeque<T, ChunkSize>::begin() const
+{
+	return const_iterator(this, 0);
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::const_iterator SharedDeque<T, ChunkSize>::cbegin() const
+{
+	return const_iterator(this, 0);
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::const_iterator SharedDeque<T, ChunkSize>::end() const
+{
+	return const_iterator(this, _size);
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::const_iterator SharedDeque<T, ChunkSize>::cend() const
+{
+	return const_iterator(this, _size);
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::_index_type& SharedDeque<T, ChunkSize>::_unique_index()
+{
+	if (!_chunks)
+		_chunks = std::make_shared<_index_type>();
+	else if (_chunks.use_count() > 1)
+		_chunks = std::make_shared<_index_type>(*_chunks);
+	else
+		std::atomic_thread_fence(std::memory_order_acquire);
+	return *_chunks;
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::_Chunk& SharedDeque<T, ChunkSize>::_unique_chunk(
+	SharedDeque<T, ChunkSize>::size_type number)
+{
+	_chunk_ptr& chunk = _unique_index()[number];
+	size_type begin = _view_begin(number);
+	size_type end = _view_end(number);
+	if (_owns_chunk(chunk))
+	{
+		//slots other copies gave up on may still hold objects
+		chunk->trim(begin, end);
+		return *chunk;
+	}
+
+	_chunk_ptr copy = std::make_shared<_Chunk>(begin);
+	for (size_type i = begin; i < end; ++i)
+	{
+		::new (static_cast<void*>(copy->data() + i)) T(chunk->data()[i]);
+		++copy->end;
+	}
+	chunk = std::move(copy);
+	return *chunk;
+}
+
+template<typename T, std::size_t ChunkSize>
+bool SharedDeque<T, ChunkSize>::_owns_chunk(const SharedDeque<T, ChunkSize>::_chunk_ptr& chunk) const
+{
+	if (chunk.use_count() > 1)
+		return false;
+	//pairs with the release in the last other owner letting go of it
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return true;
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::size_type SharedDeque<T, ChunkSize>::_view_begin(
+	SharedDeque<T, ChunkSize>::size_type number) const
+{
+	size_type first = number*ChunkSize;
+	return std::max(_offset, first) - first;
+}
+
+template<typename T, std::size_t ChunkSize>
+typename SharedDeque<T, ChunkSize>::size_type SharedDeque<T, ChunkSize>::_view_end(
+	SharedDeque<T, ChunkSize>::size_type number) const
+{
+	size_type first = number*ChunkSize;
+	return std::max(std::min(_offset + _size, first + ChunkSize), first) - first;
+}
+
+template<typename T, std::size_t ChunkSize>
+SharedDeque<T, ChunkSize>::_Chunk::_Chunk(SharedDeque<T, ChunkSize>::size_type position)
+	: begin(position), end(position)
+{
+
+}
+
+template<typename T, std::size_t ChunkSize>
+SharedDeque<T, ChunkSize>::_Chunk::~_Chunk()
+{
+	trim(end, end);
+}
+
+template<typename T, std::size_t ChunkSize>
+T* SharedDeque<T, ChunkSize>::_Chunk::data()
+{
+	return reinterpret_cast<T*>(slots);
+}
+
+template<typename T, std::size_t ChunkSize>
+void SharedDeque<T, ChunkSize>::_Chunk::trim(SharedDeque<T, ChunkSize>::size_type first,
+	SharedDeque<T, ChunkSize>::size_type last)
+{
+	//destroys whatever lies outside [first, last)
+	if (first >= last)
+		first = last = std::min(std::max(first, begin), end);
+	for (size_type i = begin; i < std::min(first, end); ++i)
+		data()[i].~T();
+	for (size_type i = std::max(last, begin); i < end; ++i)
+		data()[i].~T();
+	begin = first;
+	end = last;
+}
+
+template<typename T, std::size_t ChunkSize>
+void swap(SharedDeque<T, ChunkSize>& first, SharedDeque<T, ChunkSize>& second) noexcept
+{
+	first.swap(second);
+}
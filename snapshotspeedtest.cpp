@@ -0,0 +1,70 @@
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include "deque.hpp"
+#include "shared_deque.hpp"
+
+
+const std::size_t ROUNDS = 2000;
+//how many snapshots readers hold at any time
+const std::size_t LIVE_SNAPSHOTS = 8;
+
+//every round changes the queue a little, then takes a snapshot for a reader,
+//which looks at both ends of it; the oldest snapshot is released
+template<typename TDeque, typename TSnapshot>
+void Report(const char* name, std::size_t size, std::size_t changes, TSnapshot snapshot)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	TDeque deq;
+	for (std::size_t i = 0; i < size; ++i)
+		deq.push_back(int(i));
+
+	std::vector<TDeque> readers(LIVE_SNAPSHOTS);
+	long long checksum = 0;
+	int next = int(size);
+	clock_t::time_point start(clock_t::now());
+	for (std::size_t round = 0; round < ROUNDS; ++round)
+	{
+		for (std::size_t i = 0; i < changes; ++i)
+		{
+			deq.push_back(next++);
+			deq.pop_front();
+		}
+		TDeque& reader = readers[round % LIVE_SNAPSHOTS];
+		reader = snapshot(deq);
+		const TDeque& view = reader;
+		checksum += view.front() + view.back();
+	}
+	long long elapsed = std::chrono::duration_cast<ns_t>(clock_t::now() - start).count();
+
+	std::cout << name << ": " << elapsed/ROUNDS << "ns per round (checksum " << checksum << ")"
+		<< std::endl;
+}
+
+template<typename TDeque>
+TDeque Copy(const TDeque& deq)
+{
+	return deq;
+}
+
+void ReportSize(std::size_t size, std::size_t changes)
+{
+	std::cout << "Snapshots of " << size << " ints, " << changes << " changes between them..." << std::endl;
+	Report<std::deque<int>>("std::deque copy", size, changes, Copy<std::deque<int>>);
+	Report<Deque<int>>("Deque copy", size, changes, Copy<Deque<int>>);
+	Report<SharedDeque<int>>("SharedDeque snapshot", size, changes,
+		[](const SharedDeque<int>& deq) { return deq.snapshot(); });
+	std::cout << std::endl;
+}
+
+int main()
+{
+	ReportSize(1000, 10);
+	ReportSize(100000, 10);
+	ReportSize(100000, 1000);
+	ReportSize(1000000, 10);
+	return 0;
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <deque>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "deque.hpp"
+#include "benchmark.hpp"
+
+
+const std::size_t LOOKUPS = 1000000;
+
+double ElapsedMs(bench_clock_t::time_point start)
+{
+	return ElapsedNs(start, bench_clock_t::now())/1e6;
+}
+
+//timestamps that mostly arrive in order, each one late by up to jitter
+std::vector<int> Timestamps(std::size_t count, int jitter)
+{
+	std::default_random_engine engine(42);
+	std::uniform_int_distribution<int> late(0, jitter);
+	std::vector<int> result;
+	for (std::size_t i = 0; i < count; ++i)
+		result.push_back(int(i)*4 - late(engine));
+	return result;
+}
+
+void ReportInsert(std::size_t count, int jitter)
+{
+	std::vector<int> events = Timestamps(count, jitter);
+	std::cout << "Sorted insert of " << count << " events, jitter " << jitter << "..." << std::endl;
+
+	bench_clock_t::time_point start(bench_clock_t::now());
+	std::deque<int> stdDeque;
+	for (int event : events)
+		stdDeque.insert(std::upper_bound(stdDeque.begin(), stdDeque.end(), event), event);
+	std::cout << "std::deque + std::upper_bound: " << ElapsedMs(start) << "ms" << std::endl;
+
+	start = bench_clock_t::now();
+	Deque<int> deq;
+	for (int event : events)
+		deq.insert(std::upper_bound(deq.begin(), deq.end(), event), event);
+	std::cout << "Deque + std::upper_bound: " << ElapsedMs(start) << "ms" << std::endl;
+
+	start = bench_clock_t::now();
+	Deque<int> sorted;
+	for (int event : events)
+		sorted.insert_sorted(event);
+	std::cout << "Deque::insert_sorted: " << ElapsedMs(start) << "ms (same result: "
+		<< std::equal(sorted.begin(), sorted.end(), stdDeque.begin(), stdDeque.end()) << ")" << std::endl;
+	std::cout << std::endl;
+}
+
+void ReportMerge(std::size_t count, std::size_t batch)
+{
+	std::vector<int> events = Timestamps(count, int(count));
+	std::cout << "Merging " << count << " events in sorted batches of " << batch << "..." << std::endl;
+
+	bench_clock_t::time_point start(bench_clock_t::now());
+	std::deque<int> stdDeque;
+	for (std::size_t i = 0; i < count; i += batch)
+	{
+		std::vector<int> part(events.begin() + i, events.begin() + std::min(count, i + batch));
+		std::sort(part.begin(), part.end());
+		std::size_t middle = stdDeque.size();
+		stdDeque.insert(stdDeque.end(), part.begin(), part.end());
+		std::inplace_merge(stdDeque.begin(), stdDeque.begin() + middle, stdDeque.end());
+	}
+	std::cout << "std::deque + std::inplace_merge: " << ElapsedMs(start) << "ms" << std::endl;
+
+	start = bench_clock_t::now();
+	Deque<int> deq;
+	for (std::size_t i = 0; i < count; i += batch)
+	{
+		std::vector<int> part(events.begin() + i, events.begin() + std::min(count, i + batch));
+		std::sort(part.begin(), part.end());
+		deq.merge(part.begin(), part.end());
+	}
+	std::cout << "Deque::merge: " << ElapsedMs(start) << "ms (same result: "
+		<< std::equal(deq.begin(), deq.end(), stdDeque.begin(), stdDeque.end()) << ")" << std::endl;
+	std::cout << std::endl;
+}
+
+void ReportSortAndSearch(std::size_t count)
+{
+	std::vector<int> events = Timestamps(count, int(count));
+	std::cout << "Sorting and searching " << count << " events..." << std::endl;
+
+	std::deque<int> stdDeque;
+	Deque<int> deq;
+	Deque<int> sorted;
+	//filled from both ends, so that the ring wraps around
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (i % 2 == 0)
+		{
+			stdDeque.push_back(events[i]);
+			deq.push_back(events[i]);
+			sorted.push_back(events[i]);
+		}
+		else
+		{
+			stdDeque.push_front(events[i]);
+			deq.push_front(events[i]);
+			sorted.push_front(events[i]);
+		}
+	}
+
+	bench_clock_t::time_point start(bench_clock_t::now());
+	std::sort(stdDeque.begin(), stdDeque.end());
+	std::cout << "std::sort on std::deque: " << ElapsedMs(start) << "ms" << std::endl;
+
+	start = bench_clock_t::now();
+	std::sort(deq.begin(), deq.end());
+	std::cout << "std::sort on Deque: " << ElapsedMs(start) << "ms" << std::endl;
+
+	start = bench_clock_t::now();
+	sorted.sort();
+	std::cout << "Deque::sort: " << ElapsedMs(start) << "ms" << std::endl;
+
+	//a sorted copy laid out around the middle of the ring, so that the searches have to pick a run
+	Deque<int> wrapped;
+	for (std::size_t i = count/2; i < count; ++i)
+		wrapped.push_back(sorted[i]);
+	for (std::size_t i = count/2; i-- > 0;)
+		wrapped.push_front(sorted[i]);
+
+	std::default_random_engine engine(7);
+	std::uniform_int_distribution<int> values(-int(count), int(count)*4);
+	std::vector<int> keys;
+	for (std::size_t i = 0; i < LOOKUPS; ++i)
+		keys.push_back(values(engine));
+
+	long long checksum = 0;
+	start = bench_clock_t::now();
+	for (int key : keys)
+		checksum += std::lower_bound(stdDeque.begin(), stdDeque.end(), key) - stdDeque.begin();
+	std::cout << "std::lower_bound on std::deque: " << ElapsedMs(start)*1e6/LOOKUPS << "ns per lookup"
+		<< " (checksum " << checksum << ")" << std::endl;
+
+	checksum = 0;
+	start = bench_clock_t::now();
+	for (int key : keys)
+		checksum += std::lower_bound(deq.begin(), deq.end(), key) - deq.begin();
+	std::cout << "std::lower_bound on Deque: " << ElapsedMs(start)*1e6/LOOKUPS << "ns per lookup"
+		<< " (checksum " << checksum << ")" << std::endl;
+
+	checksum = 0;
+	start = bench_clock_t::now();
+	for (int key : keys)
+		checksum += wrapped.lower_bound(key) - wrapped.begin();
+	std::cout << "Deque::lower_bound: " << ElapsedMs(start)*1e6/LOOKUPS << "ns per lookup"
+		<< " (checksum " << checksum << ", wrapped: " << (wrapped.as_spans().second.size != 0) << ")"
+		<< std::endl;
+	std::cout << std::endl;
+}
+
+int main()
+{
+	ReportInsert(100000, 40);
+	ReportInsert(100000, 4000);
+	ReportInsert(20000, 80000);
+	ReportMerge(200000, 1000);
+	ReportSortAndSearch(1000000);
+	return 0;
+}
@@ -1,79 +1,523 @@
 #include <iostream>
+#include <fstream>
+#include <cstring>
 #include <cstdlib>
-#include <ctime>
 #include <chrono>
 #include <deque>
 #include <random>
 #include <vector>
+#include <string>
+#include <algorithm>
 #include "deque.hpp"
+#include "block_deque.hpp"
+#include "deque_allocators.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
 
+#if defined(__has_include)
+#if __has_include(<boost/circular_buffer.hpp>)
+#include <boost/circular_buffer.hpp>
+#define HAVE_BOOST_CIRCULAR_BUFFER
+#endif
+#endif
 
-long long SpeedTest(const TestData& testData)
+
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+std::size_t ResizeCount(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& deq)
+{
+	return deq.grow_count() + deq.shrink_count();
+}
+
+template<typename TContainer>
+std::size_t ResizeCount(const TContainer&)
+{
+	return 0;
+}
+
+#ifdef DEQUE_STATS
+//the counters of a stats build, printed under the timings of the same run
+template<typename T, typename TGrowthPolicy, typename TAllocator, std::size_t InlineCapacity>
+void PrintStats(const Deque<T, TGrowthPolicy, TAllocator, InlineCapacity>& deq)
+{
+	DequeStats stats = deq.stats();
+	std::cout << "    pushes " << stats.push_back << " back/" << stats.push_front << " front, pops "
+		<< stats.pop_back << " back/" << stats.pop_front << " front, resizes " << stats.grows
+		<< " up/" << stats.shrinks << " down, " << stats.bytes_copied << " bytes copied, peak size "
+		<< stats.peak_size << ", peak capacity " << stats.peak_capacity << std::endl;
+}
+
+template<typename TContainer>
+void PrintStats(const TContainer&)
+{
+
+}
+#endif
+
+//std::vector with deque operations, front operations are linear
+template<typename T>
+class VectorBaseline
+{
+public:
+	void push_back(const T& value) { _impl.push_back(value); }
+	void push_front(const T& value) { _impl.insert(_impl.begin(), value); }
+	void pop_back() { _impl.pop_back(); }
+	void pop_front() { _impl.erase(_impl.begin()); }
+	T& operator[](std::size_t index) { return _impl[index]; }
+	T& front() { return _impl.front(); }
+
+private:
+	std::vector<T> _impl;
+};
+
+#ifdef HAVE_BOOST_CIRCULAR_BUFFER
+//boost::circular_buffer never grows on its own, so it is doubled when full
+template<typename T>
+class CircularBufferBaseline
 {
-	using clock_t = std::chrono::high_resolution_clock;
-	using timepoint_t = std::chrono::time_point<clock_t>;
-	using ms_t = std::chrono::microseconds;
+public:
+	CircularBufferBaseline() : _impl(8) {}
+
+	void push_back(const T& value) { _reserve(); _impl.push_back(value); }
+	void push_front(const T& value) { _reserve(); _impl.push_front(value); }
+	void pop_back() { _impl.pop_back(); }
+	void pop_front() { _impl.pop_front(); }
+	T& operator[](std::size_t index) { return _impl[index]; }
+	T& front() { return _impl.front(); }
+
+private:
+	void _reserve() { if (_impl.full()) _impl.set_capacity(2*_impl.capacity()); }
 
-	timepoint_t start(clock_t::now());
+	boost::circular_buffer<T> _impl;
+};
+#endif
 
-	Deque<int> deq;
+const char* const OP_NAMES[] {"push_back", "push_front", "pop_back", "pop_front", "index_set"};
+const std::size_t OP_COUNT = sizeof(OP_NAMES)/sizeof(OP_NAMES[0]);
 
-	for (const auto& op : testData) 
+const unsigned SEED = 20160101;
+const std::size_t AVERAGE_OVER = 10;
+//front operations make the vector baseline quadratic, it sits out larger runs
+const std::size_t VECTOR_LIMIT = 100000;
+
+template<typename TDeque>
+void Apply(TDeque& deq, const Operation& op)
+{
+	switch (op.type)
 	{
-		switch (op.type)
-		{
-			case PushBack:
-				deq.push_back(op.param2);
-				break;
+		case PushBack:
+			deq.push_back(op.param2);
+			break;
 
-			case PushFront:
-				deq.push_front(op.param2);
-				break;
+		case PushFront:
+			deq.push_front(op.param2);
+			break;
 
-			case PopBack:
-				deq.pop_back();
-				break;
+		case PopBack:
+			deq.pop_back();
+			break;
 
-			case PopFront:
-				deq.pop_front();
-				break;
+		case PopFront:
+			deq.pop_front();
+			break;
 
-			case IndexSet:
-				deq[op.param1] = op.param2;
-				break;		
-		}
+		case IndexSet:
+			deq[op.param1] = op.param2;
+			break;
 	}
+}
+
+//replays a workload without any clocks inside the loop, returns the elapsed time
+template<typename TDeque>
+long long Replay(const TestData& testData, std::size_t& resizes)
+{
+	bench_clock_t::time_point start(bench_clock_t::now());
+
+	TDeque deq;
+	for (const auto& op : testData)
+		Apply(deq, op);
 	deq.front(); //hack so that the compiler does not optimise the whole loop out
 
-	timepoint_t end(clock_t::now());
+	long long elapsed = ElapsedNs(start, bench_clock_t::now());
+	resizes = ResizeCount(deq);
+	return elapsed;
+}
 
-	long long elapsed = std::chrono::duration_cast<ms_t>(end - start).count();
+//replays a workload timing every single operation, sorted by operation type
+template<typename TDeque>
+void TimedReplay(const TestData& testData, long long overhead, std::vector<long long>* samples)
+{
+	TDeque deq;
+	for (const auto& op : testData)
+	{
+		bench_clock_t::time_point before(bench_clock_t::now());
+		Apply(deq, op);
+		long long elapsed = ElapsedNs(before, bench_clock_t::now()) - overhead;
+		samples[op.type].push_back(elapsed > 0 ? elapsed : 0);
+	}
+	deq.front();
+}
+
+template<typename TDeque>
+void ReportWorkload(BenchmarkReport& report, const char* suite, const char* name, std::size_t size,
+	const std::vector<TestData>& tests, long long overhead)
+{
+	//warmup, so that the first measured run does not pay for cold caches and page faults
+	std::size_t resizes = 0;
+	Replay<TDeque>(tests.front(), resizes);
+
+	long long total = 0;
+	std::size_t total_resizes = 0;
+	std::vector<long long> samples[OP_COUNT];
+	for (const auto& testData : tests)
+	{
+		total += Replay<TDeque>(testData, resizes);
+		total_resizes += resizes;
+		TimedReplay<TDeque>(testData, overhead, samples);
+	}
+
+	std::vector<long long> all;
+	for (std::size_t i = 0; i < OP_COUNT; ++i)
+	{
+		all.insert(all.end(), samples[i].begin(), samples[i].end());
+		if (!samples[i].empty())
+			report.add({suite, name, size, OP_NAMES[i], Summarize(samples[i], 0), 0});
+	}
+	report.add({suite, name, size, "all", Summarize(all, total), total_resizes/tests.size()});
+
+#ifdef DEQUE_STATS
+	TDeque deq;
+	for (const auto& op : tests.front())
+		Apply(deq, op);
+	PrintStats(deq);
+#endif
+}
 
+//runs one set of workloads through every container
+void ReportContainers(BenchmarkReport& report, const char* suite, std::size_t size,
+	const std::vector<TestData>& tests, long long overhead)
+{
+	ReportWorkload<Deque<int>>(report, suite, "Default policy", size, tests, overhead);
+	ReportWorkload<Deque<int, PowerOfTwoGrowthPolicy>>(report, suite, "Power of two capacity", size,
+		tests, overhead);
+	ReportWorkload<Deque<int, GrowthPolicy<2, 8>>>(report, suite, "Lazy shrinking", size, 
+		tests, overhead);
+	ReportWorkload<Deque<int, NoShrinkGrowthPolicy>>(report, suite, "No shrinking", size, 
+		tests, overhead);
+	ReportWorkload<BlockDeque<int>>(report, suite, "Block deque", size, tests, overhead);
+	ReportWorkload<std::deque<int>>(report, suite, "std::deque", size, tests, overhead);
+#ifdef HAVE_BOOST_CIRCULAR_BUFFER
+	ReportWorkload<CircularBufferBaseline<int>>(report, suite, "boost::circular_buffer", size,
+		tests, overhead);
+#endif
+	if (size <= VECTOR_LIMIT)
+		ReportWorkload<VectorBaseline<int>>(report, suite, "std::vector", size, tests, overhead);
+}
+
+//the same workloads once through Apply and once as a single Deque::apply batch,
+//the conversion to a batch is not timed
+void ReportBatched(BenchmarkReport& report, std::size_t size, const std::vector<TestData>& tests)
+{
+	std::vector<long long> perOp;
+	std::vector<long long> batched;
+	long long perOpTotal = 0;
+	long long batchedTotal = 0;
+	std::size_t perOpResizes = 0;
+	std::size_t batchedResizes = 0;
+	std::vector<DequeOp<int>> batch;
+	for (const auto& testData : tests)
+	{
+		std::size_t resizes = 0;
+		long long elapsed = Replay<Deque<int>>(testData, resizes);
+		perOp.push_back(elapsed/(long long) testData.size());
+		perOpTotal += elapsed;
+		perOpResizes += resizes;
+
+		MakeBatch(testData, batch);
+		bench_clock_t::time_point start(bench_clock_t::now());
+		Deque<int> deq;
+		deq.apply(batch);
+		deq.empty();
+		elapsed = ElapsedNs(start, bench_clock_t::now());
+		batched.push_back(elapsed/(long long) testData.size());
+		batchedTotal += elapsed;
+		batchedResizes += ResizeCount(deq);
+	}
+
+	//the percentiles are over per-operation averages of whole runs
+	LatencySummary perOpSummary = Summarize(perOp, 0);
+	LatencySummary batchedSummary = Summarize(batched, 0);
+	perOpSummary.ops_per_sec = size*tests.size()*1e9/std::max(perOpTotal, 1ll);
+	batchedSummary.ops_per_sec = size*tests.size()*1e9/std::max(batchedTotal, 1ll);
+	report.add({"batched", "Deque per op", size, "all", perOpSummary, perOpResizes/tests.size()});
+	report.add({"batched", "Deque::apply", size, "all", batchedSummary, batchedResizes/tests.size()});
+}
+
+//how long reading the trace takes on its own, taken out of the replay times
+long long DecodeTime(const std::string& path, std::size_t& count)
+{
+	bench_clock_t::time_point start(bench_clock_t::now());
+	TraceReader reader(path);
+	Operation op;
+	long long checksum = 0;
+	for (count = 0; reader.next(op); ++count)
+		checksum += op.param2;
+	long long elapsed = ElapsedNs(start, bench_clock_t::now());
+
+	if (checksum == 1) std::cout << checksum; //keeps the loop alive
 	return elapsed;
 }
 
-int main()
+//streams a recorded trace through a container, never holding more than a buffer of it
+template<typename TDeque>
+void ReportTrace(BenchmarkReport& report, const char* name, const std::string& path,
+	long long decode, long long overhead)
 {
+	std::size_t count = 0;
+	std::size_t resizes = 0;
+	long long total = 0;
+	{
+		bench_clock_t::time_point start(bench_clock_t::now());
+		TraceReader reader(path);
+		TDeque deq;
+		Operation op;
+		for (; reader.next(op); ++count)
+			Apply(deq, op);
+		total = ElapsedNs(start, bench_clock_t::now()) - decode;
+		resizes = ResizeCount(deq);
+#ifdef DEQUE_STATS
+		PrintStats(deq);
+#endif
+	}
+
+	LatencyHistogram histograms[OP_COUNT];
+	LatencyHistogram all;
+	TraceReader reader(path);
+	TDeque deq;
+	Operation op;
+	while (reader.next(op))
+	{
+		bench_clock_t::time_point before(bench_clock_t::now());
+		Apply(deq, op);
+		long long elapsed = ElapsedNs(before, bench_clock_t::now()) - overhead;
+		histograms[op.type].add(elapsed);
+		all.add(elapsed);
+	}
+
+	for (std::size_t i = 0; i < OP_COUNT; ++i)
+	{
+		LatencySummary summary = histograms[i].summarize(0);
+		if (summary.samples > 0)
+			report.add({"trace", name, count, OP_NAMES[i], summary, 0});
+	}
+	report.add({"trace", name, count, "all", all.summarize(total > 0 ? total : 0), resizes});
+}
+
+void ReportTraceContainers(BenchmarkReport& report, const std::string& path, long long overhead)
+{
+	std::size_t count = 0;
+	long long decode = DecodeTime(path, count);
+	std::cout << "Replaying " << count << " operations from " << path << "..." << std::endl;
+
+	ReportTrace<Deque<int>>(report, "Default policy", path, decode, overhead);
+	ReportTrace<Deque<int, PowerOfTwoGrowthPolicy>>(report, "Power of two capacity", path, 
+		decode, overhead);
+	ReportTrace<Deque<int, GrowthPolicy<2, 8>>>(report, "Lazy shrinking", path, decode, overhead);
+	ReportTrace<Deque<int, NoShrinkGrowthPolicy>>(report, "No shrinking", path, decode, overhead);
+	ReportTrace<BlockDeque<int>>(report, "Block deque", path, decode, overhead);
+	ReportTrace<std::deque<int>>(report, "std::deque", path, decode, overhead);
+}
+
+//times every single push of a growing container, which is where
+//a contiguous ring pays for its copies
+template<typename TDeque>
+void ReportLatency(BenchmarkReport& report, const char* name, std::size_t count, long long overhead)
+{
+	std::vector<long long> latencies;
+	latencies.reserve(count);
+
+	TDeque deq;
+	bench_clock_t::time_point start(bench_clock_t::now());
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		bench_clock_t::time_point before(bench_clock_t::now());
+		if (i % 2 == 0)
+			deq.push_back(i);
+		else
+			deq.push_front(i);
+		long long elapsed = ElapsedNs(before, bench_clock_t::now()) - overhead;
+		latencies.push_back(elapsed > 0 ? elapsed : 0);
+	}
+	long long total = ElapsedNs(start, bench_clock_t::now());
+	deq.front();
+
+	report.add({"push_latency", name, count, "push", Summarize(latencies, total), ResizeCount(deq)});
+}
+
+//builds, fills and drops many small deques, the pattern where the allocator dominates
+template<typename TMake>
+void ReportChurn(BenchmarkReport& report, const char* name, std::size_t count,
+	std::size_t elements, long long overhead, TMake make)
+{
+	std::vector<long long> latencies;
+	latencies.reserve(count);
+
+	long long checksum = 0;
+	bench_clock_t::time_point start(bench_clock_t::now());
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		bench_clock_t::time_point before(bench_clock_t::now());
+		{
+			auto deq = make();
+			for (std::size_t j = 0; j < elements; ++j)
+				deq.push_back(j);
+			checksum += deq.back();
+		}
+		long long elapsed = ElapsedNs(before, bench_clock_t::now()) - overhead;
+		latencies.push_back(elapsed > 0 ? elapsed : 0);
+	}
+	long long total = ElapsedNs(start, bench_clock_t::now());
+
+	if (checksum < 0) std::cout << checksum; //keeps the loop alive
+	report.add({"churn", name, elements, "make_fill_drop", Summarize(latencies, total), 0});
+}
+
+void WriteReport(const BenchmarkReport& report, const char* csvPath, const char* jsonPath)
+{
+	if (csvPath != nullptr)
+	{
+		std::ofstream csv(csvPath);
+		report.write_csv(csv);
+	}
+	if (jsonPath != nullptr)
+	{
+		std::ofstream json(jsonPath);
+		report.write_json(json);
+	}
+}
+
+//speedtest [--csv FILE] [--json FILE]
+//	[--trace FILE | --record-trace FILE [--workload NAME] [--size N]]
+int main(int argc, char** argv)
+{
+	const char* csvPath = nullptr;
+	const char* jsonPath = nullptr;
+	const char* tracePath = nullptr;
+	const char* recordPath = nullptr;
+	WorkloadShape recordShape = RandomMix;
+	std::size_t recordSize = 1000000;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (std::strcmp(argv[i], "--csv") == 0)
+			csvPath = argv[i + 1];
+		else if (std::strcmp(argv[i], "--json") == 0)
+			jsonPath = argv[i + 1];
+		else if (std::strcmp(argv[i], "--trace") == 0)
+			tracePath = argv[i + 1];
+		else if (std::strcmp(argv[i], "--record-trace") == 0)
+			recordPath = argv[i + 1];
+		else if (std::strcmp(argv[i], "--size") == 0)
+			recordSize = std::strtoull(argv[i + 1], nullptr, 10);
+		else if (std::strcmp(argv[i], "--workload") == 0 && !ParseWorkload(argv[i + 1], recordShape))
+		{
+			std::cerr << "Unknown workload " << argv[i + 1] << std::endl;
+			return 1;
+		}
+	}
+
+	if (recordPath != nullptr)
+	{
+		std::default_random_engine engine(SEED);
+		TestData testData;
+		GenerateWorkload(testData, recordShape, recordSize, 10000, engine);
+		WriteTrace(recordPath, testData);
+		return 0;
+	}
+
+	BenchmarkReport report;
+	long long overhead = ClockOverhead();
+	std::cout << "Clock overhead of " << overhead << "ns is subtracted from every sample" << std::endl;
+
+	if (tracePath != nullptr)
+	{
+		ReportTraceContainers(report, tracePath, overhead);
+		WriteReport(report, csvPath, jsonPath);
+		return 0;
+	}
+
 	std::default_random_engine engine;
-	long long sizes[] {100ll, 1000ll, 10000ll, 100000ll, 1000000ll};
+	std::size_t sizes[] {100, 1000, 10000, 100000, 1000000};
 	for (auto size : sizes)
 	{
-		const size_t AVERAGE_OVER = 10;
-		std::cout << "Testing over " << size << " operations..." << std::endl;
+		//every size has its own seed, so adding a size does not change the others' data
+		engine.seed(SEED + size);
+		std::cout << std::endl << "Testing over " << size << " operations..." << std::endl;
 
-		long long average_time = 0;
-		for (size_t i = 0; i < AVERAGE_OVER; ++i)
-		{
-			TestData testData;
+		std::vector<TestData> tests(AVERAGE_OVER);
+		for (auto& testData : tests)
 			GenerateTest(testData, size, 10000, engine);
-			average_time += SpeedTest(testData);
-		}
-		average_time /= AVERAGE_OVER;
 
-		std::cout << "Finished. Average time: " << average_time << "ms" << std::endl;
+		ReportContainers(report, WorkloadName(RandomMix), size, tests, overhead);
+		ReportBatched(report, size, tests);
+	}
 
-		std::cout << std::endl;
+	const std::size_t SHAPE_SIZE = 100000;
+	for (auto shape : ALL_WORKLOADS)
+	{
+		if (shape == RandomMix)
+			continue;
+
+		engine.seed(SEED + shape);
+		std::cout << std::endl << "Testing " << WorkloadName(shape) << " over " << SHAPE_SIZE 
+			<< " operations..." << std::endl;
+
+		std::vector<TestData> tests(AVERAGE_OVER);
+		for (auto& testData : tests)
+			GenerateWorkload(testData, shape, SHAPE_SIZE, 10000, engine);
+		ReportContainers(report, WorkloadName(shape), SHAPE_SIZE, tests, overhead);
 	}
+
+	const std::size_t LATENCY_COUNT = 1000000;
+	std::cout << std::endl << "Push latency over " << LATENCY_COUNT << " elements..." << std::endl;
+	ReportLatency<Deque<int>>(report, "Ring deque", LATENCY_COUNT, overhead);
+	ReportLatency<BlockDeque<int>>(report, "Block deque", LATENCY_COUNT, overhead);
+	ReportLatency<std::deque<int>>(report, "std::deque", LATENCY_COUNT, overhead);
+
+	const std::size_t CHURN_COUNT = 1000000;
+	std::size_t churnSizes[] {4, 16, 32, 200};
+	for (auto elements : churnSizes)
+	{
+		std::cout << std::endl << "Creating and destroying " << CHURN_COUNT << " deques of "
+			<< elements << " elements..." << std::endl;
+
+		ReportChurn(report, "std::allocator", CHURN_COUNT, elements, overhead, []()
+		{
+			return Deque<int>();
+		});
+
+		BufferPool pool;
+		ReportChurn(report, "Buffer pool", CHURN_COUNT, elements, overhead, [&pool]()
+		{
+			return Deque<int, DefaultGrowthPolicy, PoolAllocator<int>>(PoolAllocator<int>(pool));
+		});
+
+		//the arena is reset every 1000 deques, as a per-request arena would be
+		MonotonicArena arena;
+		std::size_t made = 0;
+		ReportChurn(report, "Monotonic arena", CHURN_COUNT, elements, overhead, [&arena, &made]()
+		{
+			if (++made % 1000 == 0) arena.release();
+			return Deque<int, DefaultGrowthPolicy, ArenaAllocator<int>>(ArenaAllocator<int>(arena));
+		});
+		ReportChurn(report, "Inline SmallDeque<int, 16>", CHURN_COUNT, elements, overhead, []()
+		{
+			return SmallDeque<int, 16>();
+		});
+		ReportChurn(report, "std::deque", CHURN_COUNT, elements, overhead, []()
+		{
+			return std::deque<int>();
+		});
+	}
+
+	WriteReport(report, csvPath, jsonPath);
 	return 0;
 }
@@ -0,0 +1,74 @@
+#ifndef SPSC_DEQUE_HPP
+#define SPSC_DEQUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+
+//lock-free single producer/single consumer queue over the same kind of ring 
+//buffer Deque uses. the capacity is fixed at construction (rounded up to 
+//a power of two), pushes happen at the back and pops at the front.
+//exactly one thread may call the try_push* methods and exactly one 
+//other thread may call the try_pop* methods.
+template<typename T>
+class SpscDeque
+{
+public:
+	using size_type = std::size_t;
+	using value_type = T;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+
+	explicit SpscDeque(size_type);
+
+	SpscDeque(const SpscDeque<T>&) = delete;
+	SpscDeque<T>& operator=(const SpscDeque<T>&) = delete;
+
+	//size and empty are exact only when called with both sides idle
+	bool empty() const;
+	size_type size() const;
+	size_type capacity() const;
+
+	bool try_push(const_reference);
+	bool try_push(value_type&&);
+	template<typename... TArgs>
+	bool try_emplace(TArgs&&...);
+	template<typename TInputIt>
+	size_type try_push_n(TInputIt, size_type);
+
+	bool try_pop(reference);
+	template<typename TOutputIt>
+	size_type try_pop_n(TOutputIt, size_type);
+
+	~SpscDeque();
+
+private:
+	using _allocator_type = std::allocator<T>;
+	using _allocator_traits = std::allocator_traits<_allocator_type>;
+
+	static const size_type CACHE_LINE = 64;
+
+	//head and tail are ever-increasing counters, the slot is counter & _mask.
+	//each side also keeps a stale copy of the other side's counter, so that
+	//it only touches the other cache line when the stale copy says the ring is full/empty.
+	//the groups are split by a full line of padding rather than alignas, 
+	//so that the queue can still be allocated with plain new before C++17
+	std::atomic<size_type> _head;
+	size_type _cached_tail;
+	char _head_padding[CACHE_LINE];
+
+	std::atomic<size_type> _tail;
+	size_type _cached_head;
+	char _tail_padding[CACHE_LINE];
+
+	T* _impl;
+	size_type _mask;
+
+	_allocator_type _alloc;
+};
+
+#include "spsc_deque.tpp"
+
+#endif //SPSC_DEQUE_HPP
@@ -0,0 +1,148 @@
+#include "spsc_deque.hpp"
+
+template<typename T>
+SpscDeque<T>::SpscDeque(typename SpscDeque<T>::size_type capacity)
+	: _head(0), _cached_tail(0), _tail(0), _cached_head(0), _impl(nullptr), _mask(0)
+{
+	size_type size = 1;
+	while (size < capacity) 
+		size <<= 1;
+	_impl = _allocator_traits::allocate(_alloc, size);
+	_mask = size - 1;
+}
+
+template<typename T>
+bool SpscDeque<T>::empty() const
+{
+	return size() == 0;
+}
+
+template<typename T>
+typename SpscDeque<T>::size_type SpscDeque<T>::size() const
+{
+	size_type head = _head.load(std::memory_order_acquire);
+	return _tail.load(std::memory_order_acquire) - head;
+}
+
+template<typename T>
+typename SpscDeque<T>::size_type SpscDeque<T>::capacity() const
+{
+	return _mask + 1;
+}
+
+template<typename T>
+bool SpscDeque<T>::try_push(typename SpscDeque<T>::const_reference value)
+{
+	return try_emplace(value);
+}
+
+template<typename T>
+bool SpscDeque<T>::try_push(typename SpscDeque<T>::value_type&& value)
+{
+	return try_emplace(std::move(value));
+}
+
+template<typename T>
+template<typename... TArgs>
+bool SpscDeque<T>::try_emplace(TArgs&&... args)
+{
+	size_type tail = _tail.load(std::memory_order_relaxed);
+	if (tail - _cached_head > _mask)
+	{
+		_cached_head = _head.load(std::memory_order_acquire);
+		if (tail - _cached_head > _mask) 
+			return false;
+	}
+
+	_allocator_traits::construct(_alloc, _impl + (tail & _mask), std::forward<TArgs>(args)...);
+	_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T>
+template<typename TInputIt>
+typename SpscDeque<T>::size_type SpscDeque<T>::try_push_n(TInputIt first, 
+	typename SpscDeque<T>::size_type count)
+{
+	size_type tail = _tail.load(std::memory_order_relaxed);
+	if (capacity() - (tail - _cached_head) < count)
+		_cached_head = _head.load(std::memory_order_acquire);
+
+	size_type free = capacity() - (tail - _cached_head);
+	if (count > free) 
+		count = free;
+
+	//one release store publishes the whole batch
+	size_type i = 0;
+	try
+	{
+		for (; i < count; ++i, ++first)
+			_allocator_traits::construct(_alloc, _impl + ((tail + i) & _mask), *first);
+	}
+	catch (...)
+	{
+		_tail.store(tail + i, std::memory_order_release);
+		throw;
+	}
+	_tail.store(tail + count, std::memory_order_release);
+	return count;
+}
+
+template<typename T>
+bool SpscDeque<T>::try_pop(typename SpscDeque<T>::reference value)
+{
+	size_type head = _head.load(std::memory_order_relaxed);
+	if (head == _cached_tail)
+	{
+		_cached_tail = _tail.load(std::memory_order_acquire);
+		if (head == _cached_tail) 
+			return false;
+	}
+
+	T* slot = _impl + (head & _mask);
+	value = std::move(*slot);
+	_allocator_traits::destroy(_alloc, slot);
+	_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T>
+template<typename TOutputIt>
+typename SpscDeque<T>::size_type SpscDeque<T>::try_pop_n(TOutputIt out, 
+	typename SpscDeque<T>::size_type count)
+{
+	size_type head = _head.load(std::memory_order_relaxed);
+	if (_cached_tail - head < count)
+		_cached_tail = _tail.load(std::memory_order_acquire);
+
+	size_type available = _cached_tail - head;
+	if (count > available) 
+		count = available;
+
+	size_type i = 0;
+	try
+	{
+		for (; i < count; ++i, ++out)
+		{
+			T* slot = _impl + ((head + i) & _mask);
+			*out = std::move(*slot);
+			_allocator_traits::destroy(_alloc, slot);
+		}
+	}
+	catch (...)
+	{
+		_head.store(head + i, std::memory_order_release);
+		throw;
+	}
+	_head.store(head + count, std::memory_order_release);
+	return count;
+}
+
+template<typename T>
+SpscDeque<T>::~SpscDeque()
+{
+	size_type tail = _tail.load(std::memory_order_acquire);
+	for (size_type i = _head.load(std::memory_order_acquire); i != tail; ++i)
+		_allocator_traits::destroy(_alloc, _impl + (i & _mask));
+	_allocator_traits::deallocate(_alloc, _impl, _mask + 1);
+}
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include "deque.hpp"
+#include "spsc_deque.hpp"
+
+
+//the setup SpscDeque replaces: a plain Deque behind a mutex
+template<typename T>
+class MutexDeque
+{
+public:
+	using size_type = std::size_t;
+
+	explicit MutexDeque(size_type capacity)
+		: _capacity(capacity)
+	{
+
+	}
+
+	bool try_push(const T& value)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_impl.size() >= _capacity) return false;
+		_impl.push_back(value);
+		return true;
+	}
+
+	template<typename TInputIt>
+	size_type try_push_n(TInputIt first, size_type count)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		size_type i = 0;
+		for (; i < count && _impl.size() < _capacity; ++i, ++first)
+			_impl.push_back(*first);
+		return i;
+	}
+
+	bool try_pop(T& value)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_impl.empty()) return false;
+		value = _impl.front();
+		_impl.pop_front();
+		return true;
+	}
+
+	template<typename TOutputIt>
+	size_type try_pop_n(TOutputIt out, size_type count)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		size_type i = 0;
+		for (; i < count && !_impl.empty(); ++i, ++out)
+		{
+			*out = _impl.front();
+			_impl.pop_front();
+		}
+		return i;
+	}
+
+private:
+	std::mutex _mutex;
+	Deque<T> _impl;
+	size_type _capacity;
+};
+
+const std::size_t CAPACITY = 1024;
+
+template<typename TQueue>
+double Throughput(std::size_t count, std::size_t batch)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	TQueue queue(CAPACITY);
+	clock_t::time_point start(clock_t::now());
+
+	std::thread producer([&]()
+	{
+		std::vector<int> values(batch);
+		for (std::size_t i = 0; i < count;)
+		{
+			for (std::size_t j = 0; j < batch; ++j) values[j] = i + j;
+			std::size_t pushed = batch == 1
+				? queue.try_push(values[0])
+				: queue.try_push_n(values.begin(), std::min(batch, count - i));
+			if (pushed == 0) std::this_thread::yield();
+			i += pushed;
+		}
+	});
+
+	std::vector<int> values(batch);
+	long long checksum = 0;
+	for (std::size_t i = 0; i < count;)
+	{
+		std::size_t popped = batch == 1
+			? queue.try_pop(values[0])
+			: queue.try_pop_n(values.begin(), batch);
+		if (popped == 0) std::this_thread::yield();
+		for (std::size_t j = 0; j < popped; ++j) checksum += values[j];
+		i += popped;
+	}
+	producer.join();
+
+	long long elapsed = std::chrono::duration_cast<ns_t>(clock_t::now() - start).count();
+	if (checksum < 0) std::cout << checksum; //keeps the loop alive
+	return count*1e9/elapsed;
+}
+
+//round trip through two queues, half of it is the one-way hand-off latency
+template<typename TQueue>
+void Latency(const char* name, std::size_t count)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	TQueue there(CAPACITY);
+	TQueue back(CAPACITY);
+
+	std::thread echo([&]()
+	{
+		int value = 0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			while (!there.try_pop(value)) std::this_thread::yield();
+			while (!back.try_push(value)) std::this_thread::yield();
+		}
+	});
+
+	std::vector<long long> latencies;
+	latencies.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		int value = i;
+		clock_t::time_point before(clock_t::now());
+		while (!there.try_push(value)) std::this_thread::yield();
+		while (!back.try_pop(value)) std::this_thread::yield();
+		latencies.push_back(
+			std::chrono::duration_cast<ns_t>(clock_t::now() - before).count()/2);
+	}
+	echo.join();
+
+	std::sort(latencies.begin(), latencies.end());
+	std::cout << name << " latency: p50 " << latencies[count/2] << "ns, p99 "
+		<< latencies[count*99/100] << "ns" << std::endl;
+}
+
+int main()
+{
+	const std::size_t COUNT = 10000000;
+	const std::size_t LATENCY_COUNT = 100000;
+	std::size_t batches[] {1, 16, 256};
+
+	std::cout << "Handing off " << COUNT << " ints between two threads..." << std::endl;
+	for (auto batch : batches)
+	{
+		std::cout << "Batch of " << batch << ": "
+			<< "SpscDeque " << (long long) Throughput<SpscDeque<int>>(COUNT, batch) << " ops/s, "
+			<< "mutex Deque " << (long long) Throughput<MutexDeque<int>>(COUNT, batch) << " ops/s"
+			<< std::endl;
+	}
+
+	std::cout << std::endl;
+	Latency<SpscDeque<int>>("SpscDeque", LATENCY_COUNT);
+	Latency<MutexDeque<int>>("Mutex Deque", LATENCY_COUNT);
+	return 0;
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "deque.hpp"
+#include "work_stealing_deque.hpp"
+
+
+//a task is a half-open index range packed into one word, so that
+//it fits a lock-free std::atomic inside WorkStealingDeque
+using Task = std::uint64_t;
+
+Task MakeTask(std::uint32_t lo, std::uint32_t hi)
+{
+	return (Task(lo) << 32) | hi;
+}
+
+const std::uint32_t TOTAL = 1u << 24;
+const std::uint32_t GRAIN = 1u << 10;
+
+//the leaf work: a few multiply-xorshift rounds per index
+std::uint64_t Work(std::uint32_t lo, std::uint32_t hi)
+{
+	std::uint64_t sum = 0;
+	for (std::uint32_t i = lo; i < hi; ++i)
+	{
+		std::uint64_t x = i*0x9E3779B97F4A7C15ull;
+		x ^= x >> 29;
+		x *= 0xBF58476D1CE4E5B9ull;
+		sum += x ^ (x >> 32);
+	}
+	return sum;
+}
+
+//forks a task in halves until it hits the grain, running the leaves inline
+template<typename TPush>
+std::uint64_t Run(Task task, TPush push, std::atomic<std::uint32_t>& done)
+{
+	std::uint32_t lo = task >> 32;
+	std::uint32_t hi = task & 0xFFFFFFFFu;
+	while (hi - lo > GRAIN)
+	{
+		std::uint32_t mid = lo + (hi - lo)/2;
+		push(MakeTask(mid, hi));
+		hi = mid;
+	}
+	done += hi - lo;
+	return Work(lo, hi);
+}
+
+double WorkStealing(std::size_t threads)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	std::vector<std::unique_ptr<WorkStealingDeque<Task>>> deques;
+	for (std::size_t i = 0; i < threads; ++i)
+		deques.emplace_back(new WorkStealingDeque<Task>());
+	deques[0]->push_back(MakeTask(0, TOTAL));
+
+	std::atomic<std::uint32_t> done(0);
+	std::atomic<std::uint64_t> checksum(0);
+
+	auto worker = [&](std::size_t id)
+	{
+		std::minstd_rand engine(id);
+		WorkStealingDeque<Task>& own = *deques[id];
+		auto push = [&own](Task task) { own.push_back(task); };
+		std::uint64_t sum = 0;
+		Task task;
+		while (done < TOTAL)
+		{
+			if (own.pop_back(task) || deques[engine() % threads]->steal(task))
+				sum += Run(task, push, done);
+			else
+				std::this_thread::yield();
+		}
+		checksum += sum;
+	};
+
+	clock_t::time_point start(clock_t::now());
+	std::vector<std::thread> pool;
+	for (std::size_t i = 1; i < threads; ++i)
+		pool.emplace_back(worker, i);
+	worker(0);
+	for (auto& thread : pool)
+		thread.join();
+	long long elapsed = std::chrono::duration_cast<ns_t>(clock_t::now() - start).count();
+
+	if (checksum == 0) std::cout << checksum; //keeps the work alive
+	return TOTAL*1e9/elapsed;
+}
+
+double SharedDeque(std::size_t threads)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	std::mutex mutex;
+	Deque<Task> shared;
+	shared.push_back(MakeTask(0, TOTAL));
+
+	std::atomic<std::uint32_t> done(0);
+	std::atomic<std::uint64_t> checksum(0);
+
+	auto worker = [&]()
+	{
+		auto push = [&](Task task)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			shared.push_back(task);
+		};
+		std::uint64_t sum = 0;
+		while (done < TOTAL)
+		{
+			Task task;
+			bool found = false;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!shared.empty())
+				{
+					task = shared.back();
+					shared.pop_back();
+					found = true;
+				}
+			}
+			if (found)
+				sum += Run(task, push, done);
+			else
+				std::this_thread::yield();
+		}
+		checksum += sum;
+	};
+
+	clock_t::time_point start(clock_t::now());
+	std::vector<std::thread> pool;
+	for (std::size_t i = 1; i < threads; ++i)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& thread : pool)
+		thread.join();
+	long long elapsed = std::chrono::duration_cast<ns_t>(clock_t::now() - start).count();
+
+	if (checksum == 0) std::cout << checksum;
+	return TOTAL*1e9/elapsed;
+}
+
+int main()
+{
+	std::size_t cores = std::thread::hardware_concurrency();
+	if (cores == 0) cores = 1;
+
+	std::cout << "Fork-join over " << TOTAL << " items, grain " << GRAIN << "..." << std::endl;
+	for (std::size_t threads = 1; threads <= cores; threads *= 2)
+	{
+		std::cout << threads << " threads: "
+			<< "work stealing " << (long long) WorkStealing(threads) << " items/s, "
+			<< "shared mutex Deque " << (long long) SharedDeque(threads) << " items/s"
+			<< std::endl;
+	}
+	return 0;
+}
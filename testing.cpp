@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <stdexcept>
 #include "testing.hpp"
 
 
@@ -71,3 +73,259 @@ void GenerateTest(TestData& testData, std::size_t size, int VALUE_RANGE,
 		}
 	}
 }
+
+const char* WorkloadName(WorkloadShape shape)
+{
+	switch (shape)
+	{
+		case RandomMix: return "random_mix";
+		case FifoQueue: return "fifo_queue";
+		case LifoStack: return "lifo_stack";
+		case SlidingWindow: return "sliding_window";
+		case Bursty: return "bursty";
+		case Sawtooth: return "sawtooth";
+	}
+	return "unknown";
+}
+
+bool ParseWorkload(const std::string& name, WorkloadShape& shape)
+{
+	for (auto candidate : ALL_WORKLOADS)
+	{
+		if (name == WorkloadName(candidate))
+		{
+			shape = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+void GenerateWorkload(TestData& testData, WorkloadShape shape, std::size_t size, int VALUE_RANGE, 
+	std::default_random_engine& engine)
+{
+	if (shape == RandomMix)
+	{
+		GenerateTest(testData, size, VALUE_RANGE, engine);
+		return;
+	}
+
+	testData.clear();
+	testData.reserve(size);
+
+	std::uniform_int_distribution<int> value(-VALUE_RANGE, VALUE_RANGE);
+	std::bernoulli_distribution coin(0.5);
+	std::geometric_distribution<std::size_t> burst(1.0/32);
+
+	//the typical queue depth of the steady-state shapes
+	std::size_t depth = std::max<std::size_t>(16, size/100);
+	std::size_t length = 0;
+
+	auto push = [&](OpType op)
+	{
+		testData.push_back({op, 0, value(engine)});
+		++length;
+	};
+	auto pop = [&](OpType op)
+	{
+		testData.push_back({op, 0, 0});
+		--length;
+	};
+
+	while (testData.size() < size)
+	{
+		switch (shape)
+		{
+			case FifoQueue:
+			case LifoStack:
+			{
+				//a random walk pulled towards depth
+				std::bernoulli_distribution grow(length < depth ? 0.6 : 0.4);
+				if (length == 0 || grow(engine))
+					push(PushBack);
+				else
+					pop(shape == FifoQueue ? PopFront : PopBack);
+				break;
+			}
+
+			case SlidingWindow:
+				if (length < depth)
+					push(PushBack);
+				else
+					pop(PopFront);
+				break;
+
+			case Bursty:
+			{
+				std::size_t produce = 1 + burst(engine);
+				for (std::size_t i = 0; i < produce && testData.size() < size; ++i)
+					push(PushBack);
+				std::size_t consume = std::min(length, 1 + burst(engine));
+				for (std::size_t i = 0; i < consume && testData.size() < size; ++i)
+					pop(PopFront);
+				break;
+			}
+
+			case Sawtooth:
+			{
+				//climb to a peak and drain to a small fraction of it, so that
+				//every tooth crosses the shrink threshold on the way down
+				std::uniform_int_distribution<std::size_t> peak(4*depth, 16*depth);
+				std::size_t top = peak(engine);
+				while (length < top && testData.size() < size)
+					push(coin(engine) ? PushBack : PushFront);
+				std::size_t bottom = top/16;
+				while (length > bottom && testData.size() < size)
+					pop(coin(engine) ? PopBack : PopFront);
+				break;
+			}
+
+			case RandomMix:
+				break;
+		}
+
+		//a sprinkle of writes into the live range, as in the random mix
+		if (length > 0 && testData.size() < size && burst(engine) == 0)
+		{
+			std::uniform_int_distribution<std::size_t> index(0, length - 1);
+			testData.push_back({IndexSet, index(engine), value(engine)});
+		}
+	}
+}
+
+static const std::size_t TRACE_BUFFER_SIZE = 1 << 16;
+static const char TRACE_MAGIC[8] = {'D', 'E', 'Q', 'T', 'R', 'C', '0', '1'};
+
+TraceWriter::TraceWriter(const std::string& path)
+	: _out(path, std::ios::binary)
+{
+	if (!_out) 
+		throw std::runtime_error("Can not open trace " + path);
+	_buffer.reserve(TRACE_BUFFER_SIZE);
+	_buffer.insert(_buffer.end(), TRACE_MAGIC, TRACE_MAGIC + sizeof(TRACE_MAGIC));
+}
+
+void TraceWriter::record(const Operation& op)
+{
+	_put(op.type);
+	if (op.type == IndexSet)
+		_put_varint(op.param1);
+	if (op.type == PushBack || op.type == PushFront || op.type == IndexSet)
+	{
+		//zigzag, so that small negative values stay short
+		unsigned long long value = op.param2;
+		_put_varint((value << 1) ^ (op.param2 < 0 ? ~0ull : 0ull));
+	}
+}
+
+void TraceWriter::flush()
+{
+	_out.write(_buffer.data(), _buffer.size());
+	_out.flush();
+	_buffer.clear();
+}
+
+TraceWriter::~TraceWriter()
+{
+	flush();
+}
+
+void TraceWriter::_put(unsigned char byte)
+{
+	_buffer.push_back(byte);
+	if (_buffer.size() >= TRACE_BUFFER_SIZE)
+	{
+		_out.write(_buffer.data(), _buffer.size());
+		_buffer.clear();
+	}
+}
+
+void TraceWriter::_put_varint(unsigned long long value)
+{
+	while (value >= 0x80)
+	{
+		_put((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	_put(value);
+}
+
+TraceReader::TraceReader(const std::string& path)
+	: _in(path, std::ios::binary), _buffer(TRACE_BUFFER_SIZE), _position(0), _end(0)
+{
+	if (!_in) 
+		throw std::runtime_error("Can not open trace " + path);
+	for (auto expected : TRACE_MAGIC)
+	{
+		if (_position == _end && !_fill())
+			throw std::runtime_error("Not an operation trace: " + path);
+		if (_get() != (unsigned char) expected)
+			throw std::runtime_error("Not an operation trace: " + path);
+	}
+}
+
+bool TraceReader::next(Operation& op)
+{
+	if (_position == _end && !_fill())
+		return false;
+
+	unsigned char type = _get();
+	if (type > IndexSet)
+		throw std::runtime_error("Malformed trace: unknown operation");
+
+	op.type = (OpType) type;
+	op.param1 = type == IndexSet ? _get_varint() : 0;
+	op.param2 = 0;
+	if (op.type == PushBack || op.type == PushFront || op.type == IndexSet)
+	{
+		unsigned long long value = _get_varint();
+		op.param2 = (long long) (value >> 1) ^ -(long long) (value & 1);
+	}
+	return true;
+}
+
+bool TraceReader::_fill()
+{
+	_in.read(_buffer.data(), _buffer.size());
+	_position = 0;
+	_end = _in.gcount();
+	return _end > 0;
+}
+
+unsigned char TraceReader::_get()
+{
+	if (_position == _end && !_fill())
+		throw std::runtime_error("Malformed trace: truncated record");
+	return _buffer[_position++];
+}
+
+unsigned long long TraceReader::_get_varint()
+{
+	unsigned long long result = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7)
+	{
+		unsigned char byte = _get();
+		result |= (unsigned long long) (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return result;
+	}
+	throw std::runtime_error("Malformed trace: varint too long");
+}
+
+void WriteTrace(const std::string& path, const TestData& testData)
+{
+	TraceWriter writer(path);
+	for (const auto& op : testData)
+		writer.record(op);
+}
+
+void MakeBatch(const TestData& testData, std::vector<DequeOp<int>>& batch)
+{
+	const DequeOpType types[] {DequeOpType::PushBack, DequeOpType::PushFront, 
+		DequeOpType::PopBack, DequeOpType::PopFront, DequeOpType::IndexSet};
+
+	batch.clear();
+	batch.reserve(testData.size());
+	for (const auto& op : testData)
+		batch.push_back({types[op.type], std::size_t(op.param1), int(op.param2)});
+}
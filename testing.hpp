@@ -1,6 +1,9 @@
 #ifndef TESTING_HPP
 #define TESTING_HPP
 
+#include <iostream>
+#include <fstream>
+#include <string>
 #include <vector>
 #include <deque>
 #include <random>
@@ -30,4 +33,72 @@ std::ostream& operator<<(std::ostream&, const TestData&);
 
 void GenerateTest(TestData&, std::size_t, int, std::default_random_engine&);
 
+//traffic shapes for the generator. RandomMix is what GenerateTest produces,
+//Sawtooth grows and drains the deque over and over to cross the shrink threshold
+enum WorkloadShape
+{
+	RandomMix,
+	FifoQueue,
+	LifoStack,
+	SlidingWindow,
+	Bursty,
+	Sawtooth
+};
+
+const WorkloadShape ALL_WORKLOADS[] {RandomMix, FifoQueue, LifoStack, SlidingWindow, Bursty, Sawtooth};
+
+const char* WorkloadName(WorkloadShape);
+bool ParseWorkload(const std::string&, WorkloadShape&);
+
+void GenerateWorkload(TestData&, WorkloadShape, std::size_t, int, std::default_random_engine&);
+
+//operation traces on disk: an 8 byte magic followed by one record per operation,
+//a type byte and varint parameters for the operations that have them.
+//both ends stream through a small buffer, so traces may be far larger than memory
+class TraceWriter
+{
+public:
+	explicit TraceWriter(const std::string& path);
+	TraceWriter(const TraceWriter&) = delete;
+	TraceWriter& operator=(const TraceWriter&) = delete;
+
+	void record(const Operation&);
+	void flush();
+
+	~TraceWriter();
+
+private:
+	void _put(unsigned char);
+	void _put_varint(unsigned long long);
+
+	std::ofstream _out;
+	std::vector<char> _buffer;
+};
+
+class TraceReader
+{
+public:
+	explicit TraceReader(const std::string& path);
+	TraceReader(const TraceReader&) = delete;
+	TraceReader& operator=(const TraceReader&) = delete;
+
+	//false once the trace is exhausted, throws on a malformed trace
+	bool next(Operation&);
+
+private:
+	bool _fill();
+	unsigned char _get();
+	unsigned long long _get_varint();
+
+	std::ifstream _in;
+	std::vector<char> _buffer;
+	std::size_t _position;
+	std::size_t _end;
+};
+
+void WriteTrace(const std::string& path, const TestData&);
+
+//the same operations as a batch for Deque::apply
+void MakeBatch(const TestData&, std::vector<DequeOp<int>>&);
+
 #endif
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include "deque.hpp"
+
+
+const std::size_t SIZE = 1000000;
+const std::size_t REPEATS = 20;
+
+//the same int, but with user-provided copy and destructor, so that
+//Deque has to take the element-by-element path everywhere
+struct NonTrivialInt
+{
+	NonTrivialInt(int value) : value(value) {}
+	NonTrivialInt(const NonTrivialInt& other) : value(other.value) {}
+	NonTrivialInt& operator=(const NonTrivialInt& other) { value = other.value; return *this; }
+	~NonTrivialInt() {}
+
+	int value;
+};
+
+int Value(int value) { return value; }
+int Value(const NonTrivialInt& value) { return value.value; }
+
+template<typename TDeque>
+void Report(const char* name)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	long long grow = 0;
+	long long copy = 0;
+	long long insert = 0;
+	long long destroy = 0;
+	long long checksum = 0;
+	for (std::size_t repeat = 0; repeat < REPEATS; ++repeat)
+	{
+		clock_t::time_point start(clock_t::now());
+		TDeque* deq = new TDeque();
+		//both ends grow, so the ring wraps and every resize relocates two runs
+		for (std::size_t i = 0; i < SIZE/2; ++i)
+		{
+			deq->push_back(int(i));
+			deq->push_front(int(i));
+		}
+		clock_t::time_point grown(clock_t::now());
+		TDeque* duplicate = new TDeque(*deq);
+		clock_t::time_point copied(clock_t::now());
+		for (std::size_t i = 0; i < 16; ++i)
+			deq->insert(deq->begin() + deq->size()/3, int(i));
+		clock_t::time_point inserted(clock_t::now());
+		checksum += Value((*duplicate)[SIZE/3]) + Value((*deq)[SIZE/3]);
+		delete duplicate;
+		delete deq;
+		clock_t::time_point destroyed(clock_t::now());
+
+		grow += std::chrono::duration_cast<ns_t>(grown - start).count();
+		copy += std::chrono::duration_cast<ns_t>(copied - grown).count();
+		insert += std::chrono::duration_cast<ns_t>(inserted - copied).count();
+		destroy += std::chrono::duration_cast<ns_t>(destroyed - inserted).count();
+	}
+
+	double elements = (double) SIZE*REPEATS;
+	std::cout << name << ": grow " << grow/elements << "ns, copy " << copy/elements
+		<< "ns, insert " << insert/elements << "ns, destroy " << destroy/elements
+		<< "ns per element (checksum " << checksum << ")" << std::endl;
+}
+
+int main()
+{
+	std::cout << "Trivial fast paths against the generic ones, " << SIZE << " elements..." << std::endl;
+	Report<std::deque<int>>("std::deque<int>");
+	Report<std::deque<NonTrivialInt>>("std::deque<NonTrivialInt>");
+	Report<Deque<int>>("Deque<int>");
+	Report<Deque<NonTrivialInt>>("Deque<NonTrivialInt>");
+	return 0;
+}
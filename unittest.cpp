@@ -1,9 +1,32 @@
 #include <deque>
 #include <algorithm>
 #include <random>
+#include <memory>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <list>
+#include <sstream>
+#include <iterator>
+#include <numeric>
+#include <cstdio>
+#include <stdexcept>
+#include <chrono>
 #include "gtest/gtest.h"
 #include "testing.hpp"
 #include "deque.hpp"
+#include "deque_algorithm.hpp"
+#include "deque_allocators.hpp"
+#include "deque_simd.hpp"
+#include "deque_persistence.hpp"
+#include "shared_deque.hpp"
+#include "block_deque.hpp"
+#include "compact_deque.hpp"
+#include "spsc_deque.hpp"
+#include "work_stealing_deque.hpp"
+#include "sharded_deque.hpp"
+#include "deque_channel.hpp"
 
 
 namespace 
@@ -51,6 +74,56 @@ namespace
 		return res;
 	}
 
+	struct Tracked
+	{
+		static int alive;
+		static int copies;
+		int value;
+
+		Tracked(int v) : value(v) { ++alive; }
+		Tracked(const Tracked& other) : value(other.value) { ++alive; ++copies; }
+		Tracked(Tracked&& other) noexcept : value(other.value) { ++alive; }
+		Tracked& operator=(const Tracked&) = default;
+		~Tracked() { --alive; }
+	};
+
+	int Tracked::alive = 0;
+	int Tracked::copies = 0;
+
+	//a move that throws once movesLeft runs out, and a copy that never does
+	struct ThrowingMove
+	{
+		static int alive;
+		static int movesLeft;
+		std::string value;
+		//cleared by the destructor, so that a destroyed element still in the ring shows
+		const ThrowingMove* self;
+
+		ThrowingMove(int v) : value(std::string(20, 'x') + std::to_string(v)), self(this) { ++alive; }
+		ThrowingMove(const ThrowingMove& other) : value(other.value), self(this) { ++alive; }
+		ThrowingMove(ThrowingMove&& other) : value(std::move(Countdown(other).value)), self(this) { ++alive; }
+		ThrowingMove& operator=(const ThrowingMove& other) { value = other.value; return *this; }
+		ThrowingMove& operator=(ThrowingMove&& other) { value = std::move(other.value); return *this; }
+		~ThrowingMove() { self = nullptr; --alive; }
+
+		static ThrowingMove& Countdown(ThrowingMove& other)
+		{
+			if (movesLeft-- == 0) throw std::runtime_error("move");
+			return other;
+		}
+	};
+
+	int ThrowingMove::alive = 0;
+	int ThrowingMove::movesLeft = 0;
+
+	struct MoveOnlyThrowingMove : ThrowingMove
+	{
+		MoveOnlyThrowingMove(int v) : ThrowingMove(v) {}
+		MoveOnlyThrowingMove(const MoveOnlyThrowingMove&) = delete;
+		MoveOnlyThrowingMove(MoveOnlyThrowingMove&&) = default;
+		MoveOnlyThrowingMove& operator=(MoveOnlyThrowingMove&&) = default;
+	};
+
 	TEST_F(MainTestCase, ManualDequeTest)
 	{
 		Deque<int> deq;
@@ -201,8 +274,1646 @@ namespace
 		ASSERT_TRUE(Matches(deq1, oracle));
 	}
 
+	TEST_F(MainTestCase, ElementLifetimeTest)
+	{
+		Tracked::alive = 0;
+		Tracked::copies = 0;
+		{
+			Deque<Tracked> deq;
+			EXPECT_EQ(Tracked::alive, 0);
+
+			for (int i = 0; i < 100; ++i)
+			{
+				deq.emplace_back(i);
+				deq.emplace_front(-i);
+			}
+			EXPECT_EQ(Tracked::alive, 200);
+			EXPECT_EQ(Tracked::copies, 0);
+
+			deq.pop_back();
+			deq.pop_front();
+			EXPECT_EQ(Tracked::alive, 198);
+
+			for (int i = 0; i < 190; ++i) deq.pop_front();
+			EXPECT_EQ(Tracked::alive, 8);
+			EXPECT_EQ(deq.front().value, 91);
+			EXPECT_EQ(deq.back().value, 98);
+
+			deq.push_back(deq.front());
+			EXPECT_EQ(deq.back().value, 91);
+			EXPECT_EQ(Tracked::copies, 1);
+
+			deq.clear();
+			EXPECT_EQ(Tracked::alive, 0);
+			deq.emplace_back(1);
+		}
+		EXPECT_EQ(Tracked::alive, 0);
+	}
+
+	TEST_F(MainTestCase, ThrowingMoveGrowthTest)
+	{
+		ThrowingMove::alive = 0;
+		{
+			//a full wrapped ring, so that growing moves two runs
+			Deque<ThrowingMove> deq;
+			for (int i = 0; i < 5; ++i) deq.emplace_back(i);
+			for (int i = 1; i < 4; ++i) deq.emplace_front(-i);
+			ASSERT_EQ(deq.size(), deq.capacity());
+			ASSERT_GT(deq.as_spans().second.size, 0);
+
+			//the copy is taken over the move that may throw, and the ring stays as it was
+			ThrowingMove::movesLeft = 0;
+			EXPECT_THROW(deq.emplace_back(5), std::runtime_error);
+			EXPECT_EQ(deq.size(), 8);
+			EXPECT_EQ(ThrowingMove::alive, 8);
+			for (int i = 0; i < 8; ++i)
+				EXPECT_EQ(deq[i].value, std::string(20, 'x') + std::to_string(i - 3));
+
+			ThrowingMove::movesLeft = 100;
+			deq.emplace_back(5);
+			EXPECT_EQ(deq.back().value, std::string(20, 'x') + "5");
+			EXPECT_EQ(deq.front().value, std::string(20, 'x') + "-3");
+		}
+		EXPECT_EQ(ThrowingMove::alive, 0);
+
+		{
+			Deque<MoveOnlyThrowingMove> deq;
+			for (int i = 0; i < 5; ++i) deq.emplace_back(i);
+			for (int i = 1; i < 4; ++i) deq.emplace_front(-i);
+			ASSERT_EQ(deq.size(), deq.capacity());
+
+			//without a copy only the basic guarantee is left: a move fails halfway
+			//through the second run, and every element is still owned exactly once
+			ThrowingMove::movesLeft = 5;
+			EXPECT_THROW(deq.emplace_back(5), std::runtime_error);
+			EXPECT_EQ(deq.size(), 8);
+			EXPECT_EQ(ThrowingMove::alive, 8);
+			for (int i = 0; i < 8; ++i)
+				EXPECT_EQ(deq[i].self, &deq[i]);
+			//the first run was moved from, the part of the second one the move never reached was not
+			for (int i = 5; i < 8; ++i)
+				EXPECT_EQ(deq[i].value, std::string(20, 'x') + std::to_string(i - 3));
+
+			ThrowingMove::movesLeft = 100;
+			deq.emplace_back(5);
+			EXPECT_EQ(deq.size(), 9);
+			EXPECT_EQ(ThrowingMove::alive, 9);
+		}
+		EXPECT_EQ(ThrowingMove::alive, 0);
+	}
+
+	TEST_F(MainTestCase, MoveSemanticsTest)
+	{
+		Deque<std::unique_ptr<int>> deq;
+		for (int i = 0; i < 50; ++i)
+		{
+			deq.push_back(std::unique_ptr<int>(new int(i)));
+			deq.push_front(std::unique_ptr<int>(new int(-i)));
+		}
+		EXPECT_EQ(*deq.front(), -49);
+		EXPECT_EQ(*deq.back(), 49);
+
+		Deque<std::unique_ptr<int>> moved(std::move(deq));
+		EXPECT_TRUE(deq.empty());
+		EXPECT_EQ(moved.size(), 100);
+		EXPECT_EQ(*moved[50], 0);
+
+		deq.push_back(std::unique_ptr<int>(new int(7)));
+		deq = std::move(moved);
+		EXPECT_EQ(deq.size(), 100);
+		EXPECT_EQ(*deq[99], 49);
+
+		Deque<std::string> strings;
+		strings.emplace_back(5, 'a');
+		strings.emplace_front("front");
+		Deque<std::string> copy(strings);
+		strings.pop_back();
+		EXPECT_EQ(copy.back(), "aaaaa");
+		EXPECT_EQ(copy.front(), "front");
+		copy = strings;
+		EXPECT_EQ(copy.size(), 1);
+		EXPECT_EQ(copy.back(), "front");
+	}
+
+	TEST_F(MainTestCase, PowerOfTwoCapacityTest)
+	{
+		Deque<int, PowerOfTwoGrowthPolicy> deq;
+		std::deque<int> oracle;
+
+		for (int i = 0; i < 300; ++i)
+		{
+			deq.push_front(i);
+			oracle.push_front(i);
+			if (i % 3 == 0)
+			{
+				deq.push_back(-i);
+				oracle.push_back(-i);
+			}
+			EXPECT_EQ(deq.capacity() & (deq.capacity() - 1), 0);
+		}
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		deq.reserve(1000);
+		EXPECT_EQ(deq.capacity(), 1024);
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		while (deq.size() > 3)
+		{
+			deq.pop_back();
+			oracle.pop_back();
+			EXPECT_EQ(deq.capacity() & (deq.capacity() - 1), 0);
+		}
+		ASSERT_TRUE(Matches(deq, oracle));
+	}
+
+	TEST_F(MainTestCase, GrowthPolicyTest)
+	{
+		Deque<int> deq;
+		Deque<int, NoShrinkGrowthPolicy> noShrink;
+		Deque<int, GrowthPolicy<4, 16, 32>> custom;
+		EXPECT_EQ(custom.capacity(), 32);
+
+		for (int round = 0; round < 10; ++round)
+		{
+			for (int i = 0; i < 100; ++i)
+			{
+				deq.push_back(i);
+				noShrink.push_back(i);
+				custom.push_back(i);
+			}
+			for (int i = 0; i < 100; ++i)
+			{
+				deq.pop_front();
+				noShrink.pop_front();
+				custom.pop_front();
+			}
+		}
+
+		EXPECT_GT(deq.shrink_count(), 0);
+		EXPECT_EQ(noShrink.shrink_count(), 0);
+		EXPECT_EQ(noShrink.grow_count(), 4);
+		EXPECT_EQ(noShrink.capacity(), 128);
+		EXPECT_EQ(custom.capacity(), 32);
+
+		for (int i = 0; i < 20; ++i) noShrink.push_back(i);
+		noShrink.shrink_to_fit();
+		EXPECT_EQ(noShrink.capacity(), 20);
+		EXPECT_EQ(noShrink.shrink_count(), 1);
+		EXPECT_EQ(noShrink.back(), 19);
+
+		noShrink.clear();
+		noShrink.shrink_to_fit();
+		EXPECT_EQ(noShrink.capacity(), 8);
+	}
+
+	TEST_F(MainTestCase, CompactDequeTest)
+	{
+		EXPECT_EQ(sizeof(CompactDeque<int>), sizeof(int*) + 8);
+		CompactDeque<std::string> deq;
+		EXPECT_EQ(deq.capacity(), 0);
+		EXPECT_EQ(deq.memory_usage(), 0);
+		EXPECT_TRUE(deq.begin() == deq.end());
+
+		std::deque<std::string> oracle;
+		for (int i = 0; i < 40; ++i)
+		{
+			deq.push_back(std::to_string(i));
+			oracle.push_back(std::to_string(i));
+			//an argument that lives in the buffer being grown
+			deq.push_front(deq.back());
+			oracle.push_front(oracle.back());
+		}
+		ASSERT_TRUE(Matches(deq, oracle));
+		EXPECT_TRUE(std::equal(deq.rbegin(), deq.rend(), oracle.rbegin()));
+		EXPECT_EQ(deq.capacity(), 128);
+		EXPECT_EQ(deq.memory_usage(), 128*sizeof(std::string));
+
+		CompactDeque<std::string> copy(deq);
+		ASSERT_TRUE(Matches(copy, oracle));
+		while (deq.size() > 5) deq.pop_back();
+		EXPECT_EQ(deq.capacity(), 16);
+		deq.shrink_to_fit();
+		EXPECT_EQ(deq.capacity(), 8);
+
+		copy = deq;
+		deq.clear();
+		EXPECT_EQ(deq.memory_usage(), 0);
+		EXPECT_EQ(copy.size(), 5);
+		EXPECT_EQ(copy.front(), "39");
+		while (!copy.empty()) copy.pop_front();
+		EXPECT_EQ(copy.capacity(), 4);
+		copy.shrink_to_fit();
+		EXPECT_EQ(copy.memory_usage(), 0);
+
+		Deque<int> plain;
+		EXPECT_EQ(plain.memory_usage(), plain.capacity()*sizeof(int));
+		SmallDeque<int, 8> small;
+		EXPECT_EQ(small.memory_usage(), 0);
+	}
+
+	TEST_F(MainTestCase, BlockDequeTest)
+	{
+		BlockDeque<int, 4> deq;
+		std::deque<int> oracle;
+
+		deq.push_back(0);
+		const int* stable = &deq.front();
+		for (int i = 1; i < 100; ++i)
+		{
+			deq.push_back(i);
+			deq.push_front(-i);
+			oracle.push_back(i);
+			oracle.push_front(-i);
+		}
+		oracle.insert(oracle.begin() + 99, 0);
+		EXPECT_EQ(stable, &deq[99]);
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		for (int i = 0; i < 90; ++i)
+		{
+			deq.pop_front();
+			deq.pop_back();
+			oracle.pop_front();
+			oracle.pop_back();
+		}
+		EXPECT_EQ(stable, &deq[9]);
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		std::sort(deq.begin(), deq.end());
+		std::sort(oracle.begin(), oracle.end());
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		BlockDeque<int, 4> copy(deq);
+		deq.clear();
+		EXPECT_TRUE(deq.empty());
+		ASSERT_TRUE(Matches(copy, oracle));
+
+		copy.shrink_to_fit();
+		deq = std::move(copy);
+		ASSERT_TRUE(Matches(deq, oracle));
+		while (!deq.empty()) deq.pop_front();
+		deq.push_front(1);
+		EXPECT_EQ(deq.back(), 1);
+	}
+
+	TEST_F(MainTestCase, SpscDequeTest)
+	{
+		SpscDeque<std::string> queue(5);
+		EXPECT_EQ(queue.capacity(), 8);
+		EXPECT_TRUE(queue.empty());
+
+		std::string values[] {"a", "b", "c", "d", "e", "f"};
+		EXPECT_EQ(queue.try_push_n(values, 6), 6);
+		EXPECT_TRUE(queue.try_push("g"));
+		EXPECT_TRUE(queue.try_emplace(2, 'h'));
+		EXPECT_FALSE(queue.try_push("i"));
+		EXPECT_EQ(queue.try_push_n(values, 6), 0);
+		EXPECT_EQ(queue.size(), 8);
+
+		std::string out[8];
+		EXPECT_EQ(queue.try_pop_n(out, 3), 3);
+		EXPECT_EQ(out[2], "c");
+		std::string value;
+		EXPECT_TRUE(queue.try_pop(value));
+		EXPECT_EQ(value, "d");
+		EXPECT_EQ(queue.try_pop_n(out, 8), 4);
+		EXPECT_EQ(out[3], "hh");
+		EXPECT_FALSE(queue.try_pop(value));
+		EXPECT_TRUE(queue.empty());
+	}
+
+	TEST_F(MainTestCase, SpscDequeThreadedTest)
+	{
+		const int ITEMS = 100000;
+		SpscDeque<int> queue(64);
+
+		std::thread producer([&]()
+		{
+			for (int i = 0; i < ITEMS;)
+			{
+				int batch[7];
+				for (int j = 0; j < 7; ++j) batch[j] = i + j;
+				std::size_t pushed = queue.try_push_n(batch, std::min(7, ITEMS - i));
+				if (pushed == 0) std::this_thread::yield();
+				i += pushed;
+			}
+		});
+
+		int expected = 0;
+		bool ordered = true;
+		while (expected < ITEMS)
+		{
+			int value;
+			if (queue.try_pop(value)) 
+				ordered &= value == expected++;
+			else
+				std::this_thread::yield();
+		}
+		producer.join();
+
+		EXPECT_TRUE(ordered);
+		EXPECT_TRUE(queue.empty());
+	}
+
+	TEST_F(MainTestCase, WorkStealingDequeTest)
+	{
+		WorkStealingDeque<int> deq(4);
+		int value = 0;
+		EXPECT_FALSE(deq.pop_back(value));
+		EXPECT_FALSE(deq.steal(value));
+
+		for (int i = 0; i < 20; ++i) deq.push_back(i);
+		EXPECT_EQ(deq.size(), 20);
+		EXPECT_GE(deq.capacity(), 20);
+
+		EXPECT_TRUE(deq.steal(value));
+		EXPECT_EQ(value, 0);
+		EXPECT_TRUE(deq.pop_back(value));
+		EXPECT_EQ(value, 19);
+		EXPECT_TRUE(deq.steal(value));
+		EXPECT_EQ(value, 1);
+
+		for (int i = 0; i < 17; ++i) deq.pop_back(value);
+		EXPECT_EQ(value, 2);
+		EXPECT_TRUE(deq.empty());
+		EXPECT_FALSE(deq.steal(value));
+	}
+
+	TEST_F(MainTestCase, WorkStealingDequeThreadedTest)
+	{
+		const int ITEMS = 100000;
+		WorkStealingDeque<int> deq;
+		std::vector<std::atomic<int>> seen(ITEMS);
+		for (auto& counter : seen) counter = 0;
+		std::atomic<bool> done(false);
+
+		auto thief = [&]()
+		{
+			int value;
+			while (!done)
+			{
+				if (deq.steal(value)) 
+					++seen[value];
+				else
+					std::this_thread::yield();
+			}
+		};
+		std::thread thief1(thief);
+		std::thread thief2(thief);
+
+		int value;
+		for (int i = 0; i < ITEMS; ++i)
+		{
+			deq.push_back(i);
+			if (i % 3 == 0 && deq.pop_back(value)) ++seen[value];
+		}
+		while (deq.pop_back(value)) ++seen[value];
+		done = true;
+		thief1.join();
+		thief2.join();
+
+		int wrong = 0;
+		for (auto& counter : seen) wrong += counter != 1;
+		EXPECT_EQ(wrong, 0);
+	}
+
+	TEST_F(MainTestCase, ShardedDequeTest)
+	{
+		ShardedDeque<std::string> queue(3);
+		EXPECT_EQ(queue.shard_count(), 3);
+		EXPECT_LT(queue.home_shard(), 3);
+		std::string value;
+		EXPECT_FALSE(queue.try_pop(value));
+
+		queue.push("a");
+		queue.push(std::string("b"));
+		queue.emplace(2, 'c');
+		EXPECT_EQ(queue.size(), 3);
+		EXPECT_TRUE(queue.try_pop(value));
+		EXPECT_EQ(value, "a");
+		EXPECT_TRUE(queue.try_pop(value));
+		EXPECT_EQ(value, "b");
+		EXPECT_TRUE(queue.try_pop(value));
+		EXPECT_EQ(value, "cc");
+		EXPECT_TRUE(queue.empty());
+
+		ShardedDeque<int> stack(2, ShardOrder::LocalLifo);
+		for (int i = 0; i < 5; ++i) stack.push(i);
+		int top = 0;
+		EXPECT_TRUE(stack.try_pop(top));
+		EXPECT_EQ(top, 4);
+
+		//elements pushed from another shard get stolen oldest first
+		std::size_t home = stack.home_shard();
+		bool pushed = false;
+		while (!pushed)
+			std::thread([&]()
+			{
+				if (stack.home_shard() == home) return;
+				for (int i = 10; i < 15; ++i) stack.push(i);
+				pushed = true;
+			}).join();
+		for (int i = 0; i < 4; ++i) stack.try_pop(top);
+		EXPECT_EQ(top, 0);
+		EXPECT_TRUE(stack.try_pop(top));
+		EXPECT_EQ(top, 10);
+		EXPECT_EQ(stack.size(), 4);
+		EXPECT_EQ(stack.contended_locks(), 0);
+	}
+
+	TEST_F(MainTestCase, ShardedDequeThreadedTest)
+	{
+		const int PRODUCERS = 4;
+		const int CONSUMERS = 3;
+		const int ITEMS = 50000;
+		ShardedDeque<int> queue(4);
+		std::atomic<int> popped(0);
+		std::vector<std::atomic<int>> seen(PRODUCERS*ITEMS);
+		for (auto& counter : seen) counter = 0;
+		std::atomic<bool> ordered(true);
+
+		std::vector<std::thread> threads;
+		for (int p = 0; p < PRODUCERS; ++p)
+			threads.emplace_back([&, p]()
+			{
+				for (int i = 0; i < ITEMS; ++i) 
+					queue.push(p*ITEMS + i);
+			});
+		for (int c = 0; c < CONSUMERS; ++c)
+			threads.emplace_back([&]()
+			{
+				//every shard is FIFO, so one consumer sees each producer in order
+				std::vector<int> last(PRODUCERS, -1);
+				int value;
+				while (popped < PRODUCERS*ITEMS)
+				{
+					if (!queue.try_pop(value))
+					{
+						std::this_thread::yield();
+						continue;
+					}
+					++popped;
+					++seen[value];
+					if (value <= last[value/ITEMS]) ordered = false;
+					last[value/ITEMS] = value;
+				}
+			});
+		for (auto& thread : threads)
+			thread.join();
+
+		EXPECT_TRUE(ordered);
+		EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](const std::atomic<int>& count) { return count == 1; }));
+		EXPECT_TRUE(queue.empty());
+	}
+
+	TEST_F(MainTestCase, DequeChannelTest)
+	{
+		DequeChannel<std::string> channel(2);
+		EXPECT_EQ(channel.capacity(), 2);
+		EXPECT_TRUE(channel.try_push("a"));
+		EXPECT_TRUE(channel.try_push(std::string("b")));
+		EXPECT_FALSE(channel.try_push("c"));
+		EXPECT_EQ(channel.size(), 2);
+
+		std::string value;
+		EXPECT_TRUE(channel.try_pop(value));
+		EXPECT_EQ(value, "a");
+		EXPECT_TRUE(channel.pop_wait(value, std::chrono::milliseconds(10)));
+		EXPECT_EQ(value, "b");
+		EXPECT_FALSE(channel.pop_wait(value, std::chrono::milliseconds(10)));
+		EXPECT_EQ(value, "b");
+		EXPECT_FALSE(channel.try_pop(value));
+
+		//without room, a push only goes through when it meets a waiting pop
+		DequeChannel<int> rendezvous(0);
+		EXPECT_FALSE(rendezvous.try_push(1));
+		std::thread pusher([&]() { rendezvous.push_wait(7); });
+		int received = 0;
+		rendezvous.pop_wait(received);
+		pusher.join();
+		EXPECT_EQ(received, 7);
+		EXPECT_EQ(rendezvous.size(), 0);
+	}
+
+	TEST_F(MainTestCase, DequeChannelThreadedTest)
+	{
+		const int PRODUCERS = 3;
+		const int CONSUMERS = 2;
+		const int ITEMS = 20000;
+		DequeChannel<int> channel(4);
+		std::atomic<int> popped(0);
+		std::vector<std::atomic<int>> seen(PRODUCERS*ITEMS);
+		for (auto& counter : seen) counter = 0;
+		std::atomic<bool> ordered(true);
+
+		std::vector<std::thread> threads;
+		for (int p = 0; p < PRODUCERS; ++p)
+			threads.emplace_back([&, p]()
+			{
+				for (int i = 0; i < ITEMS; ++i) 
+					channel.push_wait(p*ITEMS + i);
+			});
+		for (int c = 0; c < CONSUMERS; ++c)
+			threads.emplace_back([&]()
+			{
+				std::vector<int> last(PRODUCERS, -1);
+				int value;
+				while (popped < PRODUCERS*ITEMS)
+				{
+					if (!channel.pop_wait(value, std::chrono::milliseconds(1)))
+						continue;
+					++popped;
+					++seen[value];
+					if (value <= last[value/ITEMS]) ordered = false;
+					last[value/ITEMS] = value;
+				}
+			});
+		for (auto& thread : threads)
+			thread.join();
+
+		EXPECT_TRUE(ordered);
+		EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](const std::atomic<int>& count) { return count == 1; }));
+		EXPECT_EQ(channel.size(), 0);
+	}
+
+#if DEQUE_COROUTINES
+	//starts eagerly and frees itself when done, which is all the channel tests need
+	struct Detached
+	{
+		struct promise_type
+		{
+			Detached get_return_object() { return Detached(); }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+		};
+	};
+
+	Detached ChannelProducer(DequeChannel<std::string>& channel, int count)
+	{
+		for (int i = 0; i < count; ++i)
+			co_await channel.push(std::to_string(i));
+	}
+
+	Detached ChannelConsumer(DequeChannel<std::string>& channel, int count, std::vector<std::string>& out)
+	{
+		for (int i = 0; i < count; ++i)
+			out.push_back(co_await channel.pop());
+	}
+
+	TEST_F(MainTestCase, DequeChannelCoroutineTest)
+	{
+		const int ITEMS = 1000;
+		std::vector<std::string> expected;
+		for (int i = 0; i < ITEMS; ++i) expected.push_back(std::to_string(i));
+
+		//both sides take turns suspending on the one thread
+		for (std::size_t capacity : {0, 1, 16})
+		{
+			DequeChannel<std::string> channel(capacity);
+			std::vector<std::string> received;
+			ChannelConsumer(channel, ITEMS, received);
+			EXPECT_TRUE(received.empty());
+			ChannelProducer(channel, ITEMS);
+			EXPECT_EQ(received, expected);
+			EXPECT_EQ(channel.size(), 0);
+		}
+
+		//a suspended consumer is resumed by pushes from a thread
+		DequeChannel<std::string> channel(2);
+		std::vector<std::string> received;
+		ChannelConsumer(channel, ITEMS, received);
+		std::thread producer([&]()
+		{
+			for (int i = 0; i < ITEMS; ++i) 
+				channel.push_wait(std::to_string(i));
+		});
+		producer.join();
+		EXPECT_EQ(received, expected);
+
+		//and a suspended producer by pops from one
+		ChannelProducer(channel, ITEMS);
+		std::string value;
+		std::vector<std::string> popped;
+		std::thread consumer([&]()
+		{
+			for (int i = 0; i < ITEMS; ++i)
+			{
+				channel.pop_wait(value);
+				popped.push_back(value);
+			}
+		});
+		consumer.join();
+		EXPECT_EQ(popped, expected);
+	}
+#endif
+
+	TEST_F(MainTestCase, BulkOperationsTest)
+	{
+		Deque<int> deq;
+		std::deque<int> oracle;
+		std::vector<int> values;
+		for (int i = 0; i < 100; ++i) values.push_back(i);
+
+		deq.push_back(-1);
+		deq.push_front(-2);
+		oracle.push_back(-1);
+		oracle.push_front(-2);
+
+		deq.append(values.begin(), values.end());
+		oracle.insert(oracle.end(), values.begin(), values.end());
+		EXPECT_EQ(deq.grow_count(), 1);
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		deq.pop_front_n(30);
+		oracle.erase(oracle.begin(), oracle.begin() + 30);
+		std::list<int> list(values.begin(), values.begin() + 50);
+		deq.prepend(list.begin(), list.end());
+		oracle.insert(oracle.begin(), list.begin(), list.end());
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		std::istringstream stream("7 8 9");
+		deq.prepend(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+		oracle.insert(oracle.begin(), {7, 8, 9});
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		deq.pop_back_n(40);
+		oracle.erase(oracle.end() - 40, oracle.end());
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		for (int offset : {1, 5, 20, 60, 80})
+		{
+			Deque<int>::iterator it = deq.insert(deq.cbegin() + offset, 
+				values.begin(), values.begin() + 7);
+			EXPECT_EQ(it - deq.begin(), offset);
+			oracle.insert(oracle.begin() + offset, values.begin(), values.begin() + 7);
+			ASSERT_TRUE(Matches(deq, oracle));
+
+			deq.insert(deq.begin() + offset + 3, deq[0]);
+			oracle.insert(oracle.begin() + offset + 3, oracle[0]);
+			ASSERT_TRUE(Matches(deq, oracle));
+
+			deq.erase(deq.begin() + offset / 2, deq.begin() + offset / 2 + 4);
+			oracle.erase(oracle.begin() + offset / 2, oracle.begin() + offset / 2 + 4);
+			ASSERT_TRUE(Matches(deq, oracle));
+
+			deq.erase(deq.end() - 3);
+			oracle.erase(oracle.end() - 3);
+			ASSERT_TRUE(Matches(deq, oracle));
+		}
+
+		Deque<std::string> strings;
+		std::string words[] {"b", "c", "e"};
+		strings.append(words, words + 3);
+		strings.emplace(strings.begin() + 2, "d");
+		strings.insert(strings.begin(), std::string("a"));
+		strings.erase(strings.begin() + 1);
+		EXPECT_EQ(strings.size(), 4);
+		EXPECT_EQ(strings[0] + strings[1] + strings[2] + strings[3], "acde");
+		strings.pop_front_n(4);
+		EXPECT_TRUE(strings.empty());
+	}
+
+	TEST_F(MainTestCase, SpanViewTest)
+	{
+		Deque<int> deq;
+		for (int i = 0; i < 5; ++i) deq.push_back(i);
+		for (int i = 1; i < 3; ++i) deq.push_front(-i);
+		EXPECT_EQ(deq.capacity(), 8);
+		EXPECT_GT(deq.as_spans().second.size, 0);
+
+		auto spans = deq.as_spans();
+		EXPECT_EQ(spans.first.size + spans.second.size, deq.size());
+		std::vector<int> joined(spans.first.begin(), spans.first.end());
+		joined.insert(joined.end(), spans.second.begin(), spans.second.end());
+		EXPECT_TRUE(std::equal(joined.begin(), joined.end(), deq.begin()));
+
+		int* data = deq.linearize();
+		EXPECT_EQ(deq.as_spans().second.size, 0);
+		EXPECT_EQ(data[0], -2);
+		EXPECT_EQ(data[6], 4);
+		EXPECT_EQ(&deq.front(), data);
+
+		auto span = deq.reserve_back_span(5);
+		EXPECT_GE(span.size, 5);
+		for (int i = 0; i < 5; ++i) span.data[i] = 100 + i;
+		deq.commit_back(5);
+		EXPECT_EQ(deq.size(), 12);
+		EXPECT_EQ(deq.back(), 104);
+		EXPECT_EQ(deq[7], 100);
+
+		//a full wrapped ring has no room after back()
+		Deque<int> full;
+		for (int i = 0; i < 5; ++i) full.push_back(i);
+		for (int i = 1; i < 4; ++i) full.push_front(-i);
+		ASSERT_EQ(full.size(), full.capacity());
+		ASSERT_GT(full.as_spans().second.size, 0);
+		EXPECT_EQ(full.reserve_back_span(0).size, 0);
+		auto grown = full.reserve_back_span(1);
+		EXPECT_GE(grown.size, 1);
+		EXPECT_EQ(full.front(), -3);
+
+		Deque<std::string> strings;
+		std::deque<std::string> oracle;
+		for (int i = 0; i < 5; ++i)
+		{
+			strings.push_back(std::to_string(i));
+			oracle.push_back(std::to_string(i));
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			strings.push_front(std::string(20, 'a' + i));
+			oracle.push_front(std::string(20, 'a' + i));
+		}
+		EXPECT_GT(strings.as_spans().second.size, 0);
+		strings.linearize();
+		EXPECT_EQ(strings.as_spans().first.size, 8);
+		ASSERT_TRUE(Matches(strings, oracle));
+	}
+
+	TEST_F(MainTestCase, SegmentedAlgorithmTest)
+	{
+		Deque<int> deq;
+		std::deque<int> oracle;
+		for (int i = 0; i < 100; ++i)
+		{
+			deq.push_back(i);
+			deq.push_front(-i);
+			oracle.push_back(i);
+			oracle.push_front(-i);
+		}
+		for (int i = 0; i < 30; ++i)
+		{
+			deq.pop_back();
+			oracle.pop_back();
+		}
+		ASSERT_GT(deq.as_spans().second.size, 0);
+
+		EXPECT_EQ(segmented_accumulate(deq.cbegin(), deq.cend(), 0ll), 
+			std::accumulate(oracle.begin(), oracle.end(), 0ll));
+		EXPECT_EQ(std::accumulate(deq.begin(), deq.end(), 0ll), 
+			std::accumulate(oracle.begin(), oracle.end(), 0ll));
+
+		std::vector<int> copied;
+		segmented_copy(deq.begin() + 3, deq.end() - 5, std::back_inserter(copied));
+		EXPECT_TRUE(std::equal(copied.begin(), copied.end(), oracle.begin() + 3));
+		EXPECT_EQ(copied.size(), oracle.size() - 8);
+
+		for (int value : {-99, -3, 0, 5, 69, 70})
+		{
+			EXPECT_EQ(segmented_find(deq.begin(), deq.end(), value) - deq.begin(), 
+				std::find(oracle.begin(), oracle.end(), value) - oracle.begin());
+		}
+
+		segmented_fill(deq.begin() + 10, deq.begin() + 150, 7);
+		std::fill(oracle.begin() + 10, oracle.begin() + 150, 7);
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		Deque<int>::iterator it = deq.end();
+		for (std::size_t i = deq.size(); i-- > 0;)
+			EXPECT_EQ(*--it, oracle[i]);
+		EXPECT_EQ(it, deq.begin());
+		EXPECT_EQ(deq.begin()[42], oracle[42]);
+		EXPECT_TRUE(deq.cbegin() + 5 > deq.begin() + 4);
+	}
+
+	TEST_F(MainTestCase, AllocatorTest)
+	{
+		using PoolDeque = Deque<std::string, DefaultGrowthPolicy, PoolAllocator<std::string>>;
+		BufferPool pool;
+		BufferPool otherPool;
+
+		{
+			PoolDeque deq{PoolAllocator<std::string>(pool)};
+			for (int i = 0; i < 100; ++i) deq.push_back(std::to_string(i));
+			for (int i = 0; i < 100; ++i) deq.pop_front();
+			//every buffer given up while growing and shrinking went back to the pool
+			EXPECT_GT(pool.cached(), 0u);
+
+			{
+				PoolDeque dropped{PoolAllocator<std::string>(pool)};
+			}
+			std::size_t cached = pool.cached();
+			PoolDeque reused{PoolAllocator<std::string>(pool)};
+			EXPECT_EQ(pool.cached(), cached - 1);
+
+			PoolDeque copy(deq);
+			EXPECT_EQ(copy.get_allocator(), deq.get_allocator());
+
+			//copy assignment keeps the target's allocator, move assignment and swap take the source's
+			PoolDeque other{PoolAllocator<std::string>(otherPool)};
+			deq.push_back("value");
+			other = deq;
+			EXPECT_EQ(other.get_allocator().pool(), &otherPool);
+			EXPECT_EQ(other.back(), "value");
+
+			other = std::move(copy);
+			EXPECT_EQ(other.get_allocator().pool(), &pool);
+			swap(other, reused);
+			EXPECT_EQ(reused.get_allocator().pool(), &pool);
+
+			PoolDeque moved(std::move(deq), PoolAllocator<std::string>(otherPool));
+			EXPECT_EQ(moved.get_allocator().pool(), &otherPool);
+			ASSERT_EQ(moved.size(), 1u);
+			EXPECT_EQ(moved.front(), "value");
+
+			//single-pass ranges are buffered in a temporary on the same allocator
+			std::istringstream front("a b");
+			moved.prepend(std::istream_iterator<std::string>(front), std::istream_iterator<std::string>());
+			std::istringstream middle("c");
+			moved.insert(moved.cbegin() + 2, std::istream_iterator<std::string>(middle), std::istream_iterator<std::string>());
+			std::vector<std::string> expected{"a", "b", "c", "value"};
+			EXPECT_TRUE(std::equal(moved.begin(), moved.end(), expected.begin(), expected.end()));
+			std::istringstream sorted("bb d");
+			moved.merge(std::istream_iterator<std::string>(sorted), std::istream_iterator<std::string>());
+			expected = {"a", "b", "bb", "c", "d", "value"};
+			EXPECT_TRUE(std::equal(moved.begin(), moved.end(), expected.begin(), expected.end()));
+		}
+		pool.release();
+		EXPECT_EQ(pool.cached(), 0u);
+
+		MonotonicArena arena(256);
+		{
+			Deque<int, DefaultGrowthPolicy, ArenaAllocator<int>> deq{ArenaAllocator<int>(arena)};
+			std::deque<int> oracle;
+			for (int i = 0; i < 1000; ++i)
+			{
+				deq.push_front(i);
+				oracle.push_front(i);
+			}
+			ASSERT_TRUE(Matches(deq, oracle));
+			EXPECT_GE(arena.allocated(), 1000*sizeof(int));
+		}
+		arena.release();
+		EXPECT_EQ(arena.allocated(), 0u);
+	}
+
+	TEST_F(MainTestCase, SmallDequeTest)
+	{
+		using ArenaSmallDeque = SmallDeque<int, 16, DefaultGrowthPolicy, ArenaAllocator<int>>;
+		MonotonicArena arena;
+		{
+			ArenaSmallDeque deq{ArenaAllocator<int>(arena)};
+			std::deque<int> oracle;
+			for (int i = 0; i < 16; ++i)
+			{
+				deq.push_front(i);
+				oracle.push_front(i);
+			}
+			EXPECT_EQ(deq.capacity(), 16u);
+			EXPECT_EQ(arena.allocated(), 0u);
+			ASSERT_TRUE(Matches(deq, oracle));
+
+			//spills to the heap past the inline capacity and comes back once it shrinks
+			deq.push_back(16);
+			oracle.push_back(16);
+			EXPECT_GT(arena.allocated(), 0u);
+			ASSERT_TRUE(Matches(deq, oracle));
+			for (int i = 0; i < 14; ++i)
+			{
+				deq.pop_back();
+				oracle.pop_back();
+			}
+			EXPECT_EQ(deq.capacity(), 16u);
+			EXPECT_EQ(deq.shrink_count(), 1u);
+			ASSERT_TRUE(Matches(deq, oracle));
+
+			std::size_t allocated = arena.allocated();
+			deq.clear();
+			ArenaSmallDeque other{ArenaAllocator<int>(arena)};
+			EXPECT_EQ(arena.allocated(), allocated);
+		}
+
+		Tracked::alive = 0;
+		{
+			SmallDeque<Tracked, 8> small;
+			SmallDeque<Tracked, 8> large;
+			for (int i = 0; i < 5; ++i) small.emplace_back(i);
+			for (int i = 0; i < 50; ++i) large.emplace_front(i);
+
+			//swapping an inline deque with a spilled one moves the inline elements across
+			swap(small, large);
+			EXPECT_EQ(small.size(), 50u);
+			EXPECT_EQ(large.size(), 5u);
+			EXPECT_EQ(large.back().value, 4);
+			EXPECT_EQ(small.back().value, 0);
+			EXPECT_EQ(Tracked::alive, 55);
+
+			SmallDeque<Tracked, 8> moved(std::move(large));
+			EXPECT_EQ(moved.size(), 5u);
+			EXPECT_TRUE(large.empty());
+			EXPECT_EQ(Tracked::alive, 55);
+
+			large = moved;
+			EXPECT_EQ(large.front().value, 0);
+			EXPECT_EQ(Tracked::alive, 60);
+			large = std::move(small);
+			EXPECT_EQ(large.size(), 50u);
+			EXPECT_EQ(Tracked::alive, 55);
+		}
+		EXPECT_EQ(Tracked::alive, 0);
+	}
+
+	TEST_F(MainTestCase, WorkloadTest)
+	{
+		for (auto shape : ALL_WORKLOADS)
+		{
+			TestData testData;
+			GenerateWorkload(testData, shape, 20000, RANGE, engine);
+			ASSERT_EQ(testData.size(), 20000u) << WorkloadName(shape);
+
+			//every workload is valid: no pops from an empty deque, no writes out of range
+			std::size_t length = 0;
+			std::size_t peak = 0;
+			for (const auto& op : testData)
+			{
+				if (op.type == PushBack || op.type == PushFront)
+					++length;
+				else if (op.type == PopBack || op.type == PopFront)
+					ASSERT_GT(length--, 0u) << WorkloadName(shape);
+				else
+					ASSERT_LT(op.param1, length) << WorkloadName(shape);
+				peak = std::max(peak, length);
+			}
+			EXPECT_GT(peak, 0u);
+
+			WorkloadShape parsed;
+			ASSERT_TRUE(ParseWorkload(WorkloadName(shape), parsed));
+			EXPECT_EQ(parsed, shape);
+		}
+
+		TestData testData;
+		GenerateWorkload(testData, Sawtooth, 20000, RANGE, engine);
+		testData.push_back({PushBack, 0, -(1ll << 40)});
+		testData.push_back({IndexSet, 0, 1ll << 40});
+
+		const std::string path = ::testing::TempDir() + "deque_trace.bin";
+		WriteTrace(path, testData);
+		{
+			TraceReader reader(path);
+			Operation op;
+			for (const auto& expected : testData)
+			{
+				ASSERT_TRUE(reader.next(op));
+				EXPECT_EQ(op.type, expected.type);
+				EXPECT_EQ(op.param1, expected.param1);
+				EXPECT_EQ(op.param2, expected.param2);
+			}
+			EXPECT_FALSE(reader.next(op));
+		}
+		std::remove(path.c_str());
+
+		EXPECT_THROW(TraceReader(::testing::TempDir() + "no_such_trace.bin"), std::runtime_error);
+	}
+
+#ifdef DEQUE_STATS
+	TEST_F(MainTestCase, StatsTest)
+	{
+		Deque<std::string> deq;
+		std::vector<DequeResizeEvent> events;
+		deq.set_resize_hook([&events](const DequeResizeEvent& event) { events.push_back(event); });
+
+		for (int i = 0; i < 20; ++i)
+			deq.push_back(std::to_string(i));
+		for (int i = 0; i < 5; ++i)
+			deq.push_front(std::to_string(i));
+		std::vector<std::string> values(10, "value");
+		deq.prepend(values.begin(), values.end());
+		deq.pop_back_n(30);
+		deq.pop_front();
+
+		DequeStats stats = deq.stats();
+		EXPECT_EQ(stats.push_back, 20u);
+		EXPECT_EQ(stats.push_front, 15u);
+		EXPECT_EQ(stats.pop_back, 30u);
+		EXPECT_EQ(stats.pop_front, 1u);
+		EXPECT_EQ(stats.grows, deq.grow_count());
+		EXPECT_EQ(stats.shrinks, deq.shrink_count());
+		EXPECT_EQ(stats.peak_size, 35u);
+		EXPECT_GE(stats.peak_capacity, 35u);
+		EXPECT_GT(stats.bytes_copied, 0u);
+
+		//every resize is bracketed by a begin and a finish event
+		ASSERT_EQ(events.size(), 2*(stats.grows + stats.shrinks));
+		for (std::size_t i = 0; i < events.size(); i += 2)
+		{
+			EXPECT_FALSE(events[i].finished);
+			EXPECT_TRUE(events[i + 1].finished);
+			EXPECT_EQ(events[i].new_capacity, events[i + 1].new_capacity);
+		}
+		EXPECT_EQ(events.back().new_capacity, deq.capacity());
+
+		deq.reset_stats();
+		EXPECT_EQ(deq.stats().push_back, 0u);
+		EXPECT_EQ(deq.stats().peak_size, deq.size());
+	}
+#endif
+
+	TEST_F(MainTestCase, FixedCapacityTest)
+	{
+		Deque<std::string, FixedCapacity<8>> window;
+		std::deque<std::string> oracle;
+		EXPECT_EQ(window.capacity(), 8u);
+
+		for (int i = 0; i < 30; ++i)
+		{
+			window.push_back_overwrite(std::to_string(i));
+			oracle.push_back(std::to_string(i));
+			if (oracle.size() > 8) oracle.pop_front();
+			ASSERT_TRUE(Matches(window, oracle));
+		}
+		EXPECT_EQ(window.capacity(), 8u);
+		EXPECT_EQ(window.grow_count(), 0u);
+		EXPECT_EQ(window.front(), "22");
+
+		//the new element may be built from the one it replaces
+		window.push_back_overwrite(window.front());
+		EXPECT_EQ(window.back(), "22");
+		EXPECT_EQ(window.front(), "23");
+
+		EXPECT_THROW(window.push_back("full"), std::length_error);
+		EXPECT_THROW(window.push_front("full"), std::length_error);
+		std::vector<std::string> extra(3, "extra");
+		EXPECT_THROW(window.append(extra.begin(), extra.end()), std::length_error);
+		EXPECT_EQ(window.size(), 8u);
+		EXPECT_EQ(window.back(), "22");
+
+		while (window.size() > 5) window.pop_front();
+		window.append(extra.begin(), extra.end());
+		EXPECT_EQ(window.back(), "extra");
+		EXPECT_EQ(window.capacity(), 8u);
+
+		//a moved-from window gets its buffer back on the next push
+		Deque<std::string, FixedCapacity<8>> moved(std::move(window));
+		window.push_back_overwrite("again");
+		EXPECT_EQ(window.capacity(), 8u);
+		EXPECT_EQ(window.front(), "again");
+
+		Deque<int, FixedCapacity<1000>> odd;
+		std::deque<int> oddOracle;
+		for (int i = 0; i < 5000; ++i)
+		{
+			if (i % 3 == 0)
+			{
+				odd.push_back_overwrite(i);
+				oddOracle.push_back(i);
+				if (oddOracle.size() > 1000) oddOracle.pop_front();
+			}
+			else if (i % 7 == 0 && !odd.empty())
+			{
+				odd.pop_front();
+				oddOracle.pop_front();
+			}
+		}
+		ASSERT_TRUE(Matches(odd, oddOracle));
+		EXPECT_EQ(odd.capacity(), 1000u);
+	}
+
+#if __cplusplus >= 202002L && !defined(DEQUE_STATS)
+	//runs entirely inside the compiler, so any undefined behaviour is a compile error
+	constexpr int ConstexprDequeSum()
+	{
+		Deque<int> deq;
+		for (int i = 0; i < 100; ++i)
+		{
+			if (i % 2 == 0) deq.push_back(i);
+			else deq.push_front(i);
+		}
+		deq.pop_front_n(10);
+		int extra[] = {1000, 2000};
+		deq.append(extra, extra + 2);
+		deq.insert(deq.begin() + 5, 3000);
+		deq.erase(deq.begin());
+
+		Deque<int> copy(deq);
+		copy.shrink_to_fit();
+		int sum = 0;
+		for (int value : copy) sum += value;
+		return sum;
+	}
+
+	static_assert(ConstexprDequeSum() == 4950 - (99 + 97 + 95 + 93 + 91 + 89 + 87 + 85 + 83 + 81)
+		+ 1000 + 2000 + 3000 - 79, "Deque must work in constant expressions");
+#endif
+
+	TEST_F(MainTestCase, TrivialTypeTest)
+	{
+		//the copy constructor takes both runs of a wrapped ring at once
+		Deque<int> deq;
+		std::deque<int> oracle;
+		for (int i = 0; i < 50; ++i)
+		{
+			deq.push_back(i);
+			deq.push_front(-i);
+			oracle.push_back(i);
+			oracle.push_front(-i);
+		}
+		ASSERT_NE(deq.as_spans().second.size, 0u);
+		Deque<int> copy(deq);
+		ASSERT_TRUE(Matches(copy, oracle));
+		ASSERT_TRUE(Matches(deq, oracle));
+
+		copy.pop_front_n(20);
+		copy.pop_back_n(20);
+		oracle.erase(oracle.begin(), oracle.begin() + 20);
+		oracle.erase(oracle.end() - 20, oracle.end());
+		ASSERT_TRUE(Matches(copy, oracle));
+
+		Deque<int> empty;
+		Deque<int> emptyCopy(empty);
+		EXPECT_TRUE(emptyCopy.empty());
+
+		copy.clear();
+		EXPECT_TRUE(copy.empty());
+		copy.push_back(7);
+		EXPECT_EQ(copy.front(), 7);
+	}
+
+	TEST_F(MainTestCase, SimdAlgorithmTest)
+	{
+		//every level the CPU has must agree with the standard algorithms,
+		//on a wrapped ring and on segments too short for a full vector
+		SimdLevel supported = simd_supported_level();
+		std::uniform_int_distribution<int> values(-1000, 1000);
+		for (int level = 0; level <= int(supported); ++level)
+		{
+			set_simd_level(SimdLevel(level));
+			for (int size : {1, 3, 7, 8, 9, 31, 100, 1001})
+			{
+				Deque<int> deq;
+				Deque<float> floats;
+				std::deque<int> oracle;
+				for (int i = 0; i < size; ++i)
+				{
+					int value = values(engine);
+					if (i % 2 == 0)
+					{
+						deq.push_back(value);
+						floats.push_back(float(value));
+						oracle.push_back(value);
+					}
+					else
+					{
+						deq.push_front(value);
+						floats.push_front(float(value));
+						oracle.push_front(value);
+					}
+				}
+
+				EXPECT_EQ(simd_sum(deq.cbegin(), deq.cend()), std::accumulate(oracle.begin(), oracle.end(), 0ll));
+				EXPECT_EQ(simd_sum(floats.begin(), floats.end()), double(std::accumulate(oracle.begin(), oracle.end(), 0ll)));
+				EXPECT_EQ(simd_min(deq.begin(), deq.end()), *std::min_element(oracle.begin(), oracle.end()));
+				EXPECT_EQ(simd_max(deq.begin(), deq.end()), *std::max_element(oracle.begin(), oracle.end()));
+				EXPECT_EQ(simd_min(floats.begin(), floats.end()), float(*std::min_element(oracle.begin(), oracle.end())));
+				EXPECT_EQ(simd_max(floats.begin(), floats.end()), float(*std::max_element(oracle.begin(), oracle.end())));
+
+				for (int value : {oracle.back(), oracle.front(), oracle[size/2], 5000})
+				{
+					std::ptrdiff_t expected = std::find(oracle.begin(), oracle.end(), value) - oracle.begin();
+					EXPECT_EQ(simd_find(deq.begin(), deq.end(), value) - deq.begin(), expected);
+					EXPECT_EQ(simd_find(floats.begin(), floats.end(), float(value)) - floats.begin(), expected);
+					EXPECT_EQ(simd_count(deq.begin(), deq.end(), value), 
+						std::count(oracle.begin(), oracle.end(), value));
+					EXPECT_EQ(simd_count(floats.cbegin(), floats.cend(), float(value)),
+						std::count(oracle.begin(), oracle.end(), value));
+				}
+
+				simd_transform(deq.begin() + size/3, deq.end(), 3, -7);
+				simd_transform(floats.begin() + size/3, floats.end(), 3.0f, -7.0f);
+				std::transform(oracle.begin() + size/3, oracle.end(), oracle.begin() + size/3,
+					[](int value) { return value*3 - 7; });
+				ASSERT_TRUE(Matches(deq, oracle));
+				for (int i = 0; i < size; ++i)
+					ASSERT_EQ(floats[i], float(oracle[i]));
+
+				simd_fill(deq.begin() + 1, deq.end(), 42);
+				std::fill(oracle.begin() + 1, oracle.end(), 42);
+				ASSERT_TRUE(Matches(deq, oracle));
+			}
+		}
+		set_simd_level(supported);
+		EXPECT_EQ(simd_level(), supported);
+	}
+
+	TEST_F(MainTestCase, PersistenceTest)
+	{
+		Deque<long long> deq;
+		std::deque<long long> oracle;
+		std::uniform_int_distribution<long long> values(-RANGE, RANGE);
+		for (int i = 0; i < 1000; ++i)
+		{
+			long long value = values(engine);
+			if (i % 3 == 0)
+			{
+				deq.push_front(value);
+				oracle.push_front(value);
+			}
+			else
+			{
+				deq.push_back(value);
+				oracle.push_back(value);
+			}
+		}
+		ASSERT_NE(deq.as_spans().second.size, 0u);
+
+		std::stringstream stream;
+		save_deque(stream, deq);
+		Deque<long long> loaded;
+		loaded.push_back(7);
+		load_deque(stream, loaded);
+		ASSERT_TRUE(Matches(loaded, oracle));
+
+		std::stringstream empty;
+		save_deque(empty, Deque<long long>());
+		load_deque(empty, loaded);
+		EXPECT_TRUE(loaded.empty());
+
+		std::stringstream garbage("definitely not a deque");
+		EXPECT_THROW(load_deque(garbage, loaded), std::runtime_error);
+		std::stringstream ints;
+		save_deque(ints, Deque<int>());
+		EXPECT_THROW(load_deque(ints, loaded), std::runtime_error);
+		std::string truncated = stream.str().substr(0, stream.str().size() - 1);
+		std::stringstream cut(truncated);
+		EXPECT_THROW(load_deque(cut, loaded), std::runtime_error);
+
+		const std::string path = ::testing::TempDir() + "mapped_deque.bin";
+		std::remove(path.c_str());
+		{
+			MappedDeque<long long> mapped(path, 4);
+			EXPECT_EQ(mapped.capacity(), 4u);
+			for (long long value : oracle)
+				mapped.push_back(value);
+			for (int i = 0; i < 100; ++i)
+			{
+				mapped.pop_front();
+				oracle.pop_front();
+				mapped.push_front(-i);
+				oracle.push_front(-i);
+				mapped.pop_back();
+				oracle.pop_back();
+			}
+			EXPECT_GE(mapped.capacity(), oracle.size());
+		}
+		{
+			//reopening restores the contents, and growth keeps a wrapped ring in order
+			MappedDeque<long long> mapped(path);
+			ASSERT_EQ(mapped.size(), oracle.size());
+			for (std::size_t i = 0; i < oracle.size(); ++i)
+				ASSERT_EQ(mapped[i], oracle[i]);
+			while (mapped.size() < 3000)
+			{
+				mapped.push_front((long long) mapped.size());
+				oracle.push_front((long long) oracle.size());
+			}
+			EXPECT_EQ(mapped.front(), oracle.front());
+			EXPECT_EQ(mapped.back(), oracle.back());
+			mapped.sync();
+		}
+		{
+			MappedDeque<long long> mapped(path);
+			ASSERT_EQ(mapped.size(), oracle.size());
+			for (std::size_t i = 0; i < oracle.size(); ++i)
+				ASSERT_EQ(mapped[i], oracle[i]);
+			mapped.clear();
+			EXPECT_TRUE(mapped.empty());
+		}
+		EXPECT_THROW(MappedDeque<int>{path}, std::runtime_error);
+		std::remove(path.c_str());
+	}
+
+	TEST_F(MainTestCase, SharedDequeTest)
+	{
+		Tracked::alive = 0;
+		{
+			//small chunks, so that the operations cross chunk borders all the time
+			SharedDeque<Tracked, 4> deq;
+			std::deque<int> oracle;
+			std::vector<std::pair<SharedDeque<Tracked, 4>, std::deque<int>>> snapshots;
+			std::uniform_int_distribution<int> ops(0, 6);
+			for (int i = 0; i < 5000; ++i)
+			{
+				int op = ops(engine);
+				if (oracle.empty() || op < 2)
+				{
+					deq.push_back(Tracked(i));
+					oracle.push_back(i);
+				}
+				else if (op < 4)
+				{
+					deq.push_front(Tracked(i));
+					oracle.push_front(i);
+				}
+				else if (op == 4)
+				{
+					deq.pop_back();
+					oracle.pop_back();
+				}
+				else if (op == 5)
+				{
+					deq.pop_front();
+					oracle.pop_front();
+				}
+				else
+				{
+					deq[oracle.size()/2].value = -i;
+					oracle[oracle.size()/2] = -i;
+				}
+
+				if (i % 97 == 0)
+					snapshots.emplace_back(deq.snapshot(), oracle);
+				if (snapshots.size() > 8)
+					snapshots.erase(snapshots.begin());
+			}
+
+			ASSERT_EQ(deq.size(), oracle.size());
+			for (std::size_t i = 0; i < oracle.size(); ++i)
+				ASSERT_EQ(deq[i].value, oracle[i]);
+			for (const auto& snapshot : snapshots)
+			{
+				ASSERT_EQ(snapshot.first.size(), snapshot.second.size());
+				EXPECT_TRUE(std::equal(snapshot.first.begin(), snapshot.first.end(), snapshot.second.begin(),
+					[](const Tracked& first, int second) { return first.value == second; }));
+			}
+
+			SharedDeque<Tracked, 4> copy(deq);
+			copy.clear();
+			EXPECT_TRUE(copy.empty());
+			EXPECT_EQ(deq.size(), oracle.size());
+			while (!deq.empty())
+				deq.pop_front();
+			EXPECT_FALSE(snapshots.back().first.empty());
+		}
+		EXPECT_EQ(Tracked::alive, 0);
+	}
+
+	TEST_F(MainTestCase, SharedDequeThreadedTest)
+	{
+		//a reader walks each snapshot while the writer keeps changing the original
+		const int ROUNDS = 2000;
+		SharedDeque<int, 16> deq;
+		for (int i = 0; i < 1000; ++i)
+			deq.push_back(i);
+
+		SpscDeque<SharedDeque<int, 16>*> handoff(8);
+		std::atomic<bool> consistent(true);
+		std::thread reader([&]()
+		{
+			for (int round = 0; round < ROUNDS;)
+			{
+				SharedDeque<int, 16>* snapshot;
+				if (!handoff.try_pop(snapshot))
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				//every snapshot holds consecutive numbers
+				for (std::size_t i = 1; i < snapshot->size(); ++i)
+				{
+					if ((*snapshot)[i] != (*snapshot)[i - 1] + 1)
+						consistent = false;
+				}
+				delete snapshot;
+				++round;
+			}
+		});
+
+		int next = 1000;
+		for (int round = 0; round < ROUNDS; ++round)
+		{
+			SharedDeque<int, 16>* snapshot = new SharedDeque<int, 16>(deq.snapshot());
+			while (!handoff.try_push(snapshot))
+				std::this_thread::yield();
+			for (int i = 0; i < 37; ++i)
+			{
+				deq.push_back(next++);
+				deq.pop_front();
+			}
+		}
+		reader.join();
+		EXPECT_TRUE(consistent);
+		EXPECT_EQ(deq.front(), next - 1000);
+	}
+
+	TEST_F(MainTestCase, SortedOperationsTest)
+	{
+		//keys repeat, the second member tells whether equal keys kept insertion order
+		using Event = std::pair<int, int>;
+		auto byKey = [](const Event& a, const Event& b) { return a.first < b.first; };
+		std::uniform_int_distribution<int> keys(0, 50);
+
+		Deque<int> unsorted;
+		std::deque<int> sorted;
+		for (int i = 0; i < 300; ++i)
+		{
+			int key = keys(engine);
+			if (i % 2 == 0)
+				unsorted.push_back(key);
+			else
+				unsorted.push_front(key);
+			sorted.push_back(key);
+		}
+		ASSERT_NE(unsorted.as_spans().second.size, 0u);
+		unsorted.sort();
+		std::sort(sorted.begin(), sorted.end());
+		ASSERT_TRUE(Matches(unsorted, sorted));
+		unsorted.sort(std::greater<int>());
+		std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+		ASSERT_TRUE(Matches(unsorted, sorted));
+
+		//the searches must agree with the standard ones on both runs of a wrapped ring
+		Deque<int> wrapped;
+		for (int i = 0; i < 40; ++i)
+		{
+			wrapped.push_back(60 + 2*(i/3));
+			wrapped.push_front(60 - 2*(i/3));
+		}
+		ASSERT_NE(wrapped.as_spans().second.size, 0u);
+		const Deque<int>& view = wrapped;
+		for (int value = 20; value < 100; ++value)
+		{
+			EXPECT_EQ(wrapped.lower_bound(value) - wrapped.begin(), 
+				std::lower_bound(view.begin(), view.end(), value) - view.begin());
+			EXPECT_EQ(view.upper_bound(value) - view.begin(), 
+				std::upper_bound(view.begin(), view.end(), value) - view.begin());
+		}
+		Deque<int> empty;
+		EXPECT_EQ(empty.lower_bound(1), empty.end());
+
+		Deque<Event> deq;
+		std::deque<Event> oracle;
+		int sequence = 0;
+		for (int i = 0; i < 500; ++i)
+		{
+			Event event(keys(engine), sequence++);
+			deq.insert_sorted(event, byKey);
+			oracle.insert(std::upper_bound(oracle.begin(), oracle.end(), event, byKey), event);
+		}
+		ASSERT_TRUE(std::equal(deq.begin(), deq.end(), oracle.begin(), oracle.end()));
+
+		//batches that overlap the front, the back, the middle and nothing at all
+		for (int round = 0; round < 40; ++round)
+		{
+			std::uniform_int_distribution<int> low(-10, 60);
+			int from = low(engine);
+			std::uniform_int_distribution<int> high(from, from + 20);
+			std::vector<Event> batch;
+			for (int i = 0; i < round % 7 + 1; ++i)
+				batch.emplace_back(high(engine), sequence++);
+			std::stable_sort(batch.begin(), batch.end(), byKey);
+
+			if (round % 2 == 0)
+			{
+				deq.merge(batch.begin(), batch.end(), byKey);
+			}
+			else
+			{
+				std::list<Event> listed(batch.begin(), batch.end());
+				deq.merge(listed.begin(), listed.end(), byKey);
+			}
+			std::size_t middle = oracle.size();
+			oracle.insert(oracle.end(), batch.begin(), batch.end());
+			std::inplace_merge(oracle.begin(), oracle.begin() + middle, oracle.end(), byKey);
+			ASSERT_TRUE(std::equal(deq.begin(), deq.end(), oracle.begin(), oracle.end()));
+		}
+
+		Deque<std::string> strings;
+		std::vector<std::string> words = {"b", "d", "f"};
+		strings.merge(words.begin(), words.end());
+		strings.insert_sorted(std::string("c"));
+		std::vector<std::string> more = {"a", "e", "g"};
+		strings.merge(std::make_move_iterator(more.begin()), std::make_move_iterator(more.end()));
+		EXPECT_TRUE(Matches(strings, std::vector<std::string>{"a", "b", "c", "d", "e", "f", "g"}));
+	}
+
+	TEST_F(MainTestCase, BatchApplyTest)
+	{
+		//whole workloads and slices of them must end where replaying them one by one does
+		for (auto shape : ALL_WORKLOADS)
+		{
+			TestData testData;
+			GenerateWorkload(testData, shape, 5000, RANGE, engine);
+			std::vector<DequeOp<int>> batch;
+			MakeBatch(testData, batch);
+
+			Deque<int> oneByOne;
+			for (const auto& op : batch)
+			{
+				switch (op.type)
+				{
+					case DequeOpType::PushBack: oneByOne.push_back(op.value); break;
+					case DequeOpType::PushFront: oneByOne.push_front(op.value); break;
+					case DequeOpType::PopBack: oneByOne.pop_back(); break;
+					case DequeOpType::PopFront: oneByOne.pop_front(); break;
+					case DequeOpType::IndexSet: oneByOne[op.index] = op.value; break;
+				}
+			}
+
+			Deque<int> whole;
+			whole.apply(batch);
+			ASSERT_TRUE(Matches(whole, oneByOne)) << WorkloadName(shape);
+			EXPECT_LE(whole.grow_count(), 1u);
+
+			Deque<int, PowerOfTwoGrowthPolicy> sliced;
+			for (std::size_t i = 0; i < batch.size(); i += 37)
+				sliced.apply(batch.begin() + i, batch.begin() + std::min(batch.size(), i + 37));
+			ASSERT_TRUE(Matches(sliced, oneByOne)) << WorkloadName(shape);
+		}
+
+		//cancelled pushes are never built, leftover pops take elements that were there
+		using Op = DequeOp<std::string>;
+		Deque<std::string> deq;
+		for (int i = 0; i < 6; ++i)
+			deq.push_back(std::to_string(i));
+		std::vector<Op> batch = {
+			{DequeOpType::PushBack, 0, "a"}, {DequeOpType::PushBack, 0, "b"}, 
+			{DequeOpType::PopBack, 0, ""}, {DequeOpType::PushBack, 0, "c"},
+			{DequeOpType::PopBack, 0, ""}, {DequeOpType::PopBack, 0, ""}, 
+			{DequeOpType::PopBack, 0, ""}, {DequeOpType::PushBack, 0, "d"},
+			{DequeOpType::PushFront, 0, "e"}, {DequeOpType::PushFront, 0, "f"},
+			{DequeOpType::PushFront, 0, "g"}, {DequeOpType::PopFront, 0, ""},
+			{DequeOpType::IndexSet, 2, "h"},
+			{DequeOpType::PopFront, 0, ""}, {DequeOpType::PopFront, 0, ""}, 
+			{DequeOpType::PopFront, 0, ""}, {DequeOpType::PushFront, 0, "i"}};
+		deq.apply(batch);
+		EXPECT_TRUE(Matches(deq, std::vector<std::string>{"i", "1", "2", "3", "4", "d"}));
+
+		deq.apply(std::vector<Op>{{DequeOpType::PopFront, 0, ""}, {DequeOpType::PopFront, 0, ""}, 
+			{DequeOpType::PushFront, 0, "j"}, {DequeOpType::PopBack, 0, ""}});
+		EXPECT_TRUE(Matches(deq, std::vector<std::string>{"j", "2", "3", "4"}));
+
+		//a bad batch is refused before anything changes
+		std::vector<Op> tooManyPops(5, Op{DequeOpType::PopBack, 0, ""});
+		EXPECT_THROW(deq.apply(tooManyPops), std::out_of_range);
+		std::vector<Op> badIndex = {{DequeOpType::PushBack, 0, "k"}, {DequeOpType::IndexSet, 5, "l"}};
+		EXPECT_THROW(deq.apply(badIndex), std::out_of_range);
+		EXPECT_TRUE(Matches(deq, std::vector<std::string>{"j", "2", "3", "4"}));
+
+		deq.apply(std::vector<Op>());
+		EXPECT_EQ(deq.size(), 4u);
+	}
+
 	std::default_random_engine engine;
 	
+	template<typename TDeque>
+	::testing::AssertionResult RunRandomized(const TestData& testData)
+	{
+		TDeque deq;
+		std::deque<short> oracle;
+
+		for (auto op : testData) 
+		{
+			switch (op.type)
+			{
+				case PushBack:
+					oracle.push_back(op.param2);
+					deq.push_back(op.param2);
+					break;
+
+				case PushFront:
+					oracle.push_front(op.param2);
+					deq.push_front(op.param2);
+					break;
+
+				case PopBack:
+					oracle.pop_back();
+					deq.pop_back();
+					break;
+
+				case PopFront:
+					oracle.pop_front();
+					deq.pop_front();
+					break;
+
+				case IndexSet:
+					oracle[op.param1] = op.param2;
+					deq[op.param1] = op.param2;
+					break;
+			}
+			::testing::AssertionResult res = Matches(deq, oracle);
+			if (!res) return res;
+		}
+		return ::testing::AssertionSuccess();
+	}
+
+	TEST_F(MainTestCase, RandomizedBlockDequeTest)
+	{
+		ASSERT_TRUE((RunRandomized<BlockDeque<short, 4>>(_testData))) << _testData;
+		ASSERT_TRUE(RunRandomized<BlockDeque<short>>(_testData)) << _testData;
+	}
+
+	TEST_F(MainTestCase, RandomizedCompactDequeTest)
+	{
+		ASSERT_TRUE(RunRandomized<CompactDeque<short>>(_testData)) << _testData;
+	}
+
+	TEST_F(MainTestCase, RandomizedSmallDequeTest)
+	{
+		ASSERT_TRUE((RunRandomized<SmallDeque<short, 4>>(_testData))) << _testData;
+		ASSERT_TRUE((RunRandomized<SmallDeque<short, 16, PowerOfTwoGrowthPolicy>>(_testData))) << _testData;
+	}
+
 	TEST_F(MainTestCase, RandomizedDequeTest)
 	{
 		Deque<short> deq;
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <vector>
+#include "deque.hpp"
+
+
+const std::size_t SAMPLES = 10000000;
+//every SCAN_EVERY samples the whole window is walked by index
+const std::size_t SCAN_EVERY = 64;
+
+//rolling sum over the last Window samples, plus a periodic full scan of the window
+//as an aggregation that can not be kept incrementally would need
+template<typename TWindow, std::size_t Window, typename TPush>
+void Report(const char* name, const std::vector<int>& samples, TPush push)
+{
+	using clock_t = std::chrono::steady_clock;
+	using ns_t = std::chrono::nanoseconds;
+
+	TWindow window;
+	long long sum = 0;
+	long long checksum = 0;
+	clock_t::time_point start(clock_t::now());
+	for (std::size_t i = 0; i < samples.size(); ++i)
+	{
+		if (window.size() == Window)
+			sum -= window.front();
+		push(window, samples[i]);
+		sum += samples[i];
+		checksum += sum;
+
+		if (i % SCAN_EVERY == 0)
+		{
+			int peak = window[0];
+			for (std::size_t j = 1; j < window.size(); ++j)
+				peak = std::max(peak, window[j]);
+			checksum += peak;
+		}
+	}
+	long long elapsed = std::chrono::duration_cast<ns_t>(clock_t::now() - start).count();
+
+	std::cout << name << ": " << (double) elapsed/samples.size() << "ns per sample"
+		<< " (checksum " << checksum << ")" << std::endl;
+}
+
+//the emulation a bounded mode replaces: push, then trim the front
+template<std::size_t Window>
+struct PushPop
+{
+	template<typename TWindow>
+	void operator()(TWindow& window, int value) const
+	{
+		window.push_back(value);
+		if (window.size() > Window)
+			window.pop_front();
+	}
+};
+
+struct Overwrite
+{
+	template<typename TWindow>
+	void operator()(TWindow& window, int value) const
+	{
+		window.push_back_overwrite(value);
+	}
+};
+
+template<std::size_t Window>
+void ReportWindow()
+{
+	std::cout << "Sliding window of " << Window << " over " << SAMPLES << " samples..." << std::endl;
+
+	std::minstd_rand engine(Window);
+	std::vector<int> samples(SAMPLES);
+	for (auto& sample : samples)
+		sample = engine() % 1000;
+
+	Report<std::deque<int>, Window>("std::deque push/pop", samples, PushPop<Window>());
+	Report<Deque<int>, Window>("Deque push/pop", samples, PushPop<Window>());
+	Report<Deque<int, NoShrinkGrowthPolicy>, Window>("No shrinking Deque push/pop", samples,
+		PushPop<Window>());
+	Report<Deque<int, FixedCapacity<Window>>, Window>("Fixed capacity overwrite", samples,
+		Overwrite());
+	Report<SmallDeque<int, Window, FixedCapacity<Window>>, Window>("Inline fixed capacity overwrite",
+		samples, Overwrite());
+	std::cout << std::endl;
+}
+
+int main()
+{
+	ReportWindow<16>();
+	ReportWindow<1000>();
+	ReportWindow<1024>();
+	return 0;
+}
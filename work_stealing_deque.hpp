@@ -0,0 +1,80 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include <cstddef>
+
+
+//Chase-Lev work-stealing deque. the owning thread pushes and pops at the back
+//without locks, any number of other threads steal from the front.
+//the ring grows like Deque::_resize does, but the old buffer may still be
+//read by a thief, so it is retired and only freed with the deque itself.
+//elements are stored in std::atomic<T>, so T should be a small trivially
+//copyable type such as a task pointer.
+template<typename T>
+class WorkStealingDeque
+{
+public:
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using value_type = T;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+
+	explicit WorkStealingDeque(size_type = DEFAULT_SIZE);
+
+	WorkStealingDeque(const WorkStealingDeque<T>&) = delete;
+	WorkStealingDeque<T>& operator=(const WorkStealingDeque<T>&) = delete;
+
+	//size and empty are exact only when no other thread is stealing
+	bool empty() const;
+	size_type size() const;
+	size_type capacity() const;
+
+	//pop_back and steal write value only when they return true
+
+	//owner thread only
+	void push_back(const_reference);
+	bool pop_back(reference);
+
+	//any thread
+	bool steal(reference);
+
+private:
+	struct _Buffer
+	{
+		explicit _Buffer(size_type);
+
+		T load(difference_type) const;
+		void store(difference_type, const_reference);
+
+		size_type mask;
+		std::unique_ptr<std::atomic<T>[]> slots;
+	};
+
+	_Buffer* _grow(_Buffer*, difference_type, difference_type);
+
+	static const size_type CACHE_LINE = 64;
+	static const size_type DEFAULT_SIZE = 64;
+
+	//a full line of padding between the hot fields instead of alignas, 
+	//so that the deque can still be allocated with plain new before C++17
+	std::atomic<difference_type> _top;
+	char _top_padding[CACHE_LINE];
+	std::atomic<difference_type> _bottom;
+	char _bottom_padding[CACHE_LINE];
+	std::atomic<_Buffer*> _buffer;
+
+	//every buffer ever used, touched by the owner only
+	std::vector<std::unique_ptr<_Buffer>> _buffers;
+
+	static_assert(std::is_trivially_copyable<T>::value, 
+		"WorkStealingDeque elements must be trivially copyable");
+};
+
+#include "work_stealing_deque.tpp"
+
+#endif //WORK_STEALING_DEQUE_HPP
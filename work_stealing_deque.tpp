@@ -0,0 +1,132 @@
+#include "work_stealing_deque.hpp"
+
+template<typename T>
+WorkStealingDeque<T>::_Buffer::_Buffer(typename WorkStealingDeque<T>::size_type capacity)
+	: mask(capacity - 1), slots(new std::atomic<T>[capacity])
+{
+
+}
+
+template<typename T>
+T WorkStealingDeque<T>::_Buffer::load(typename WorkStealingDeque<T>::difference_type index) const
+{
+	return slots[index & mask].load(std::memory_order_relaxed);
+}
+
+template<typename T>
+void WorkStealingDeque<T>::_Buffer::store(typename WorkStealingDeque<T>::difference_type index, 
+	typename WorkStealingDeque<T>::const_reference value)
+{
+	slots[index & mask].store(value, std::memory_order_relaxed);
+}
+
+template<typename T>
+WorkStealingDeque<T>::WorkStealingDeque(typename WorkStealingDeque<T>::size_type capacity)
+	: _top(0), _bottom(0), _buffer(nullptr)
+{
+	size_type size = 1;
+	while (size < capacity) 
+		size <<= 1;
+	_buffers.emplace_back(new _Buffer(size));
+	_buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::empty() const
+{
+	return size() == 0;
+}
+
+template<typename T>
+typename WorkStealingDeque<T>::size_type WorkStealingDeque<T>::size() const
+{
+	difference_type bottom = _bottom.load(std::memory_order_relaxed);
+	difference_type top = _top.load(std::memory_order_relaxed);
+	return bottom > top ? bottom - top : 0;
+}
+
+template<typename T>
+typename WorkStealingDeque<T>::size_type WorkStealingDeque<T>::capacity() const
+{
+	return _buffer.load(std::memory_order_relaxed)->mask + 1;
+}
+
+template<typename T>
+void WorkStealingDeque<T>::push_back(typename WorkStealingDeque<T>::const_reference value)
+{
+	difference_type bottom = _bottom.load(std::memory_order_relaxed);
+	difference_type top = _top.load(std::memory_order_acquire);
+	_Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+
+	if (bottom - top > static_cast<difference_type>(buffer->mask)) 
+		buffer = _grow(buffer, top, bottom);
+
+	buffer->store(bottom, value);
+	std::atomic_thread_fence(std::memory_order_release);
+	_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::pop_back(typename WorkStealingDeque<T>::reference value)
+{
+	difference_type bottom = _bottom.load(std::memory_order_relaxed) - 1;
+	_Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+	_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	difference_type top = _top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	T popped = buffer->load(bottom);
+	if (top < bottom) 
+	{
+		value = popped;
+		return true;
+	}
+
+	//last element, race the thieves for it, and leave value alone if one wins
+	bool won = _top.compare_exchange_strong(top, top + 1, 
+		std::memory_order_seq_cst, std::memory_order_relaxed);
+	_bottom.store(bottom + 1, std::memory_order_relaxed);
+	if (won) 
+		value = popped;
+	return won;
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::steal(typename WorkStealingDeque<T>::reference value)
+{
+	difference_type top = _top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	difference_type bottom = _bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom) 
+		return false;
+
+	T stolen = _buffer.load(std::memory_order_acquire)->load(top);
+	if (!_top.compare_exchange_strong(top, top + 1, 
+		std::memory_order_seq_cst, std::memory_order_relaxed))
+		return false;
+
+	value = stolen;
+	return true;
+}
+
+template<typename T>
+typename WorkStealingDeque<T>::_Buffer* WorkStealingDeque<T>::_grow(
+	typename WorkStealingDeque<T>::_Buffer* buffer, 
+	typename WorkStealingDeque<T>::difference_type top, 
+	typename WorkStealingDeque<T>::difference_type bottom)
+{
+	std::unique_ptr<_Buffer> grown(new _Buffer(2*(buffer->mask + 1)));
+	for (difference_type i = top; i < bottom; ++i)
+		grown->store(i, buffer->load(i));
+
+	_buffers.push_back(std::move(grown));
+	_buffer.store(_buffers.back().get(), std::memory_order_release);
+	return _buffers.back().get();
+}